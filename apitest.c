@@ -0,0 +1,417 @@
+/*
+ * 库接口测试工具，check.sh 用它调用命令行用不到的接口，
+ * 输出再与 test_resize 单独缩放同一输入的结果逐字节比较
+ *
+ * 用法：
+ *   sws_apitest multi 输入 宽 高 格式 输出前缀 宽x高...
+ *       一个源图像同时缩放到多个尺寸（sws_scale_multi），第i路写到 输出前缀_宽x高.raw
+ *   sws_apitest pyramid 输入 宽 高 格式 输出前缀 层数
+ *       逐层减半的金字塔（sws_scale_pyramid），第k层写到 输出前缀_k.raw
+ *   sws_apitest flip 输入 宽 高 格式 输出 目标宽 目标高 [目标格式]
+ *       源和目标都自底向上存放（负跨距），各平面分别由调用者分配，按16行的切片调用 sws_scale()
+ *   sws_apitest batch 输入 宽 高 格式 输出 目标宽 目标高 帧数 线程数
+ *       输入中的每一帧是一个任务，用 sws_scale_batch() 多线程缩放，结果依次写到输出
+ *
+ * 最后加上 -drop 平面号 时，去掉源图像的这个平面（batch 只去掉最后一个任务的），
+ * 接口必须返回错误，程序返回1；崩溃或者成功都说明缺少平面没有被检查出来
+ * 输入输出都是 test_resize 使用的原始格式，格式名与 test_resize 相同
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "swscale_internal.h"
+#include "imgutils.h"
+
+#define STRIDE_ALIGN 64     // 跨距大于行宽，顺便检查各接口是否按跨距寻址
+#define MAX_OUTPUTS  8
+
+static int drop_plane = -1;   ///< -drop 指定的平面，-1表示不去掉
+
+typedef struct Image {
+    uint8_t *data[4];
+    int linesize[4];
+    int width, height;
+    enum AVPixelFormat format;
+} Image;
+
+static int alloc_image(Image *img, int width, int height, enum AVPixelFormat fmt)
+{
+    int ret;
+
+    memset(img, 0, sizeof(*img));
+    if ((ret = av_image_alloc(img->data, img->linesize, width, height, fmt, STRIDE_ALIGN)) < 0)
+        return ret;
+    img->width = width;
+    img->height = height;
+    img->format = fmt;
+    return 0;
+}
+
+// 按行读写一帧，跳过行尾的填充，跨距可以为负
+static int read_image(FILE *f, Image *img)
+{
+    int rowBytes[4], rows[4];
+
+    av_image_plane_sizes(rowBytes, rows, img->format, img->width, img->height);
+    for (int i = 0; i < 4; i++)
+        for (int y = 0; y < rows[i]; y++)
+            if (fread(img->data[i] + (ptrdiff_t)y * img->linesize[i], 1, rowBytes[i], f) != rowBytes[i])
+                return -1;
+    return 0;
+}
+
+static int write_image(FILE *f, const Image *img)
+{
+    int rowBytes[4], rows[4];
+
+    av_image_plane_sizes(rowBytes, rows, img->format, img->width, img->height);
+    for (int i = 0; i < 4; i++)
+        for (int y = 0; y < rows[i]; y++)
+            if (fwrite(img->data[i] + (ptrdiff_t)y * img->linesize[i], 1, rowBytes[i], f) != rowBytes[i])
+                return -1;
+    return 0;
+}
+
+static int load_image(Image *img, const char *name, int width, int height, enum AVPixelFormat fmt)
+{
+    FILE *f = fopen(name, "rb");
+    int ret;
+
+    if (!f) {
+        fprintf(stderr, "Fail to open %s\n", name);
+        return -1;
+    }
+    if ((ret = alloc_image(img, width, height, fmt)) >= 0 && (ret = read_image(f, img)) < 0)
+        fprintf(stderr, "Fail to read %s\n", name);
+    fclose(f);
+    return ret;
+}
+
+static int save_image(const Image *img, const char *name)
+{
+    FILE *f = fopen(name, "wb");
+    int ret;
+
+    if (!f) {
+        fprintf(stderr, "Fail to open %s\n", name);
+        return -1;
+    }
+    if ((ret = write_image(f, img)) < 0)
+        fprintf(stderr, "Fail to write %s\n", name);
+    fclose(f);
+    return ret;
+}
+
+// 与 test_resize 相同的参数，不初始化
+static SwsContext *alloc_context(int srcW, int srcH, enum AVPixelFormat srcFormat,
+                                 int dstW, int dstH, enum AVPixelFormat dstFormat)
+{
+    SwsContext *c = av_mallocz(sizeof(SwsContext));
+
+    if (!c)
+        return NULL;
+    c->srcW = srcW;
+    c->srcH = srcH;
+    c->srcFormat = srcFormat;
+    c->dstW = dstW;
+    c->dstH = dstH;
+    c->dstFormat = dstFormat;
+    c->flags = 2;
+    return c;
+}
+
+/*
+ 分配自底向上存放的一帧：每个平面单独分配，互不相连，
+ data[i] 指向图像的第一行，也就是缓冲区的最后一行，跨距为负
+*/
+static int alloc_bottom_up(Image *img, uint8_t *bufs[4], int width, int height, enum AVPixelFormat fmt)
+{
+    int rowBytes[4], rows[4];
+
+    memset(img, 0, sizeof(*img));
+    av_image_plane_sizes(rowBytes, rows, fmt, width, height);
+    for (int i = 0; i < 4; i++) {
+        int stride = FFALIGN(rowBytes[i], STRIDE_ALIGN);
+
+        bufs[i] = NULL;
+        if (!rowBytes[i])
+            continue;
+        bufs[i] = av_malloc((size_t)stride * rows[i]);
+        if (!bufs[i])
+            return -12;
+        img->data[i] = bufs[i] + (size_t)stride * (rows[i] - 1);
+        img->linesize[i] = -stride;
+    }
+    img->width = width;
+    img->height = height;
+    img->format = fmt;
+    return 0;
+}
+
+static int test_multi(const Image *src, const char *prefix, char **sizes, int nb_outputs)
+{
+    SwsContext *outputs[MAX_OUTPUTS] = { NULL };
+    SwsMultiContext m = { 0 };
+    Image dst[MAX_OUTPUTS] = { { { NULL } } };
+    uint8_t **dstp[MAX_OUTPUTS];
+    int *dstStride[MAX_OUTPUTS];
+    char name[1024];
+    int i, ret = -1;
+
+    if (nb_outputs <= 0 || nb_outputs > MAX_OUTPUTS) {
+        fprintf(stderr, "multi: 1 to %d outputs\n", MAX_OUTPUTS);
+        return -22;
+    }
+    for (i = 0; i < nb_outputs; i++) {
+        int w, h;
+
+        if (sscanf(sizes[i], "%dx%d", &w, &h) != 2 || w <= 0 || h <= 0) {
+            fprintf(stderr, "multi: invalid size '%s'\n", sizes[i]);
+            goto end;
+        }
+        outputs[i] = alloc_context(src->width, src->height, src->format, w, h, src->format);
+        if (!outputs[i] || alloc_image(&dst[i], w, h, src->format) < 0)
+            goto end;
+        dstp[i] = dst[i].data;
+        dstStride[i] = dst[i].linesize;
+    }
+
+    m.nb_outputs = nb_outputs;
+    m.outputs = outputs;
+    if ((ret = sws_init_multi_context(&m)) < 0)
+        goto end;
+    // 调用者的上下文不能被改成内部使用的平面格式
+    for (i = 0; i < nb_outputs; i++) {
+        if (outputs[i]->srcFormat != src->format) {
+            fprintf(stderr, "multi: output %d source format changed to %s\n",
+                    i, av_pix_fmt_desc_get(outputs[i]->srcFormat)->name);
+            ret = -1;
+            goto end;
+        }
+    }
+    if ((ret = sws_scale_multi(&m, (const uint8_t *const *)src->data, src->linesize, dstp, dstStride)) < 0)
+        goto end;
+
+    for (i = 0; i < nb_outputs; i++) {
+        snprintf(name, sizeof(name), "%s_%s.raw", prefix, sizes[i]);
+        if ((ret = save_image(&dst[i], name)) < 0)
+            goto end;
+    }
+    ret = 0;
+
+end:
+    // 初始化成功后输出上下文归多路上下文所有
+    if (m.outputs)
+        sws_free_multi_context(&m);
+    else
+        for (i = 0; i < nb_outputs; i++)
+            sws_freeContext(outputs[i]);
+    for (i = 0; i < nb_outputs; i++)
+        av_free(dst[i].data[0]);
+    return ret;
+}
+
+static int test_pyramid(const Image *src, const char *prefix, int nb_levels)
+{
+    SwsPyramidContext p = { 0 };
+    Image *dst = NULL;
+    uint8_t ***dstp = NULL;
+    int **dstStride = NULL;
+    char name[1024];
+    int k, ret;
+
+    if ((ret = sws_init_pyramid_context(&p, src->width, src->height, src->format, nb_levels)) < 0)
+        goto end;
+    dst = av_mallocz_array(nb_levels, sizeof(*dst));
+    dstp = av_mallocz_array(nb_levels, sizeof(*dstp));
+    dstStride = av_mallocz_array(nb_levels, sizeof(*dstStride));
+    ret = -12;
+    if (!dst || !dstp || !dstStride)
+        goto end;
+    for (k = 0; k < nb_levels; k++) {
+        if (alloc_image(&dst[k], p.levelW[k + 1], p.levelH[k + 1], src->format) < 0)
+            goto end;
+        dstp[k] = dst[k].data;
+        dstStride[k] = dst[k].linesize;
+    }
+
+    if ((ret = sws_scale_pyramid(&p, (const uint8_t *const *)src->data, src->linesize, dstp, dstStride)) < 0)
+        goto end;
+    for (k = 0; k < nb_levels; k++) {
+        snprintf(name, sizeof(name), "%s_%d.raw", prefix, k + 1);
+        if ((ret = save_image(&dst[k], name)) < 0)
+            goto end;
+    }
+
+end:
+    for (k = 0; dst && k < nb_levels; k++)
+        av_free(dst[k].data[0]);
+    av_free(dst);
+    av_free(dstp);
+    av_free(dstStride);
+    sws_free_pyramid_context(&p);
+    return ret;
+}
+
+static int test_flip(const Image *src, const char *outname, int dstW, int dstH, enum AVPixelFormat dstFormat)
+{
+    SwsContext *c = alloc_context(src->width, src->height, src->format, dstW, dstH, dstFormat);
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(src->format);
+    uint8_t *srcBufs[4] = { NULL }, *dstBufs[4] = { NULL };
+    Image bsrc, bdst;
+    int rowBytes[4], rows[4];
+    int y, i, ret = -12;
+
+    if (!c)
+        return -12;
+    if ((ret = sws_init_context(c)) < 0 ||
+        (ret = alloc_bottom_up(&bsrc, srcBufs, src->width, src->height, src->format)) < 0 ||
+        (ret = alloc_bottom_up(&bdst, dstBufs, dstW, dstH, dstFormat)) < 0)
+        goto end;
+
+    // 源图像逐行拷贝成自底向上存放
+    av_image_plane_sizes(rowBytes, rows, src->format, src->width, src->height);
+    for (i = 0; i < 4; i++)
+        for (y = 0; y < rows[i]; y++)
+            memcpy(bsrc.data[i] + (ptrdiff_t)y * bsrc.linesize[i],
+                   src->data[i] + (ptrdiff_t)y * src->linesize[i], rowBytes[i]);
+
+    // 按切片送入，切片起点必须对齐到色度行
+    for (y = 0; y < src->height; y += 16) {
+        int sliceH = FFMIN(16, src->height - y);
+        const uint8_t *slice[4];
+
+        for (i = 0; i < 4; i++) {
+            int sliceY = (i == 1 || i == 2) ? y >> desc->log2_chroma_h : y;
+            slice[i] = bsrc.data[i] ? bsrc.data[i] + (ptrdiff_t)sliceY * bsrc.linesize[i] : NULL;
+        }
+        if ((ret = sws_scale(c, slice, bsrc.linesize, y, sliceH, bdst.data, bdst.linesize)) < 0)
+            goto end;
+    }
+    ret = save_image(&bdst, outname);
+
+end:
+    for (i = 0; i < 4; i++) {
+        av_free(srcBufs[i]);
+        av_free(dstBufs[i]);
+    }
+    sws_freeContext(c);
+    return ret;
+}
+
+static int test_batch(const char *inname, int width, int height, enum AVPixelFormat fmt,
+                      const char *outname, int dstW, int dstH, int nb_jobs, int nb_threads)
+{
+    SwsContext *c = alloc_context(width, height, fmt, dstW, dstH, fmt);
+    SwsBatchContext b = { 0 };
+    SwsBatchJob *jobs = av_mallocz_array(nb_jobs, sizeof(*jobs));
+    Image *src = av_mallocz_array(nb_jobs, sizeof(*src));
+    Image *dst = av_mallocz_array(nb_jobs, sizeof(*dst));
+    FILE *in = fopen(inname, "rb"), *out = NULL;
+    int i, ret = -12;
+
+    if (!c || !jobs || !src || !dst || !in)
+        goto end;
+    if ((ret = sws_init_context(c)) < 0 || (ret = sws_init_batch_context(&b, c, nb_threads)) < 0)
+        goto end;
+    for (i = 0; i < nb_jobs; i++) {
+        if ((ret = alloc_image(&src[i], width, height, fmt)) < 0 ||
+            (ret = alloc_image(&dst[i], dstW, dstH, fmt)) < 0)
+            goto end;
+        if ((ret = read_image(in, &src[i])) < 0) {
+            fprintf(stderr, "Fail to read frame %d of %s\n", i, inname);
+            goto end;
+        }
+        memcpy(jobs[i].src, src[i].data, sizeof(jobs[i].src));
+        memcpy(jobs[i].srcStride, src[i].linesize, sizeof(jobs[i].srcStride));
+        memcpy(jobs[i].dst, dst[i].data, sizeof(jobs[i].dst));
+        memcpy(jobs[i].dstStride, dst[i].linesize, sizeof(jobs[i].dstStride));
+    }
+    // 只有最后一个任务缺少平面，它可能由别的线程处理，错误也要返回给调用者
+    if (drop_plane >= 0) {
+        jobs[nb_jobs - 1].src[drop_plane] = NULL;
+        jobs[nb_jobs - 1].srcStride[drop_plane] = 0;
+    }
+
+    if ((ret = sws_scale_batch(&b, jobs, nb_jobs)) < 0)
+        goto end;
+    ret = -1;
+    if (!(out = fopen(outname, "wb")))
+        goto end;
+    for (i = 0; i < nb_jobs; i++)
+        if ((ret = write_image(out, &dst[i])) < 0)
+            goto end;
+
+end:
+    if (in)
+        fclose(in);
+    if (out)
+        fclose(out);
+    for (i = 0; i < nb_jobs && src && dst; i++) {
+        av_free(src[i].data[0]);
+        av_free(dst[i].data[0]);
+    }
+    av_free(jobs);
+    av_free(src);
+    av_free(dst);
+    sws_free_batch_context(&b);
+    sws_freeContext(c);
+    return ret;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *usage = "usage: sws_apitest multi input width height format prefix WxH...\n"
+                        "       sws_apitest pyramid input width height format prefix levels\n"
+                        "       sws_apitest flip input width height format output dstW dstH [dstFormat]\n"
+                        "       sws_apitest batch input width height format output dstW dstH frames threads\n"
+                        "       append -drop plane to remove a source plane, the test must then fail";
+    enum AVPixelFormat fmt;
+    Image src = { { NULL } };
+    int ret;
+
+    if (argc > 2 && !strcmp(argv[argc - 2], "-drop")) {
+        drop_plane = atoi(argv[argc - 1]);
+        argc -= 2;
+        if (drop_plane < 1 || drop_plane > 3) {
+            fprintf(stderr, "-drop: plane 1 to 3\n");
+            return -1;
+        }
+    }
+    if (argc < 7) {
+        fprintf(stderr, "%s\n", usage);
+        return -1;
+    }
+    fmt = getPixelFormatFromString(argv[5]);
+    if (fmt == AV_PIX_FMT_NONE) {
+        fprintf(stderr, "Unknown pixel format '%s'\n", argv[5]);
+        return -1;
+    }
+    if (load_image(&src, argv[2], atoi(argv[3]), atoi(argv[4]), fmt) < 0)
+        return -1;
+    // data[0] 是整块内存的起点，不能去掉
+    if (drop_plane >= 0) {
+        src.data[drop_plane] = NULL;
+        src.linesize[drop_plane] = 0;
+    }
+
+    if (!strcmp(argv[1], "multi")) {
+        ret = test_multi(&src, argv[6], argv + 7, argc - 7);
+    } else if (!strcmp(argv[1], "pyramid") && argc == 8) {
+        ret = test_pyramid(&src, argv[6], atoi(argv[7]));
+    } else if (!strcmp(argv[1], "flip") && (argc == 9 || argc == 10)) {
+        enum AVPixelFormat dstFormat = argc == 10 ? getPixelFormatFromString(argv[9]) : fmt;
+
+        ret = dstFormat == AV_PIX_FMT_NONE ? -22 : test_flip(&src, argv[6], atoi(argv[7]), atoi(argv[8]), dstFormat);
+    } else if (!strcmp(argv[1], "batch") && argc == 11) {
+        ret = test_batch(argv[2], src.width, src.height, fmt, argv[6],
+                         atoi(argv[7]), atoi(argv[8]), atoi(argv[9]), atoi(argv[10]));
+    } else {
+        fprintf(stderr, "Unknown test '%s'\n%s\n", argv[1], usage);
+        ret = -1;
+    }
+
+    av_free(src.data[0]);
+    return ret < 0 ? 1 : 0;
+}
@@ -0,0 +1,153 @@
+#define _XOPEN_SOURCE 600
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "swscale_internal.h"
+
+typedef struct BatchThread {
+    SwsContext *c;
+    const SwsBatchJob *jobs;
+    int first;                    ///< 第一个任务的索引
+    int step;                     ///< 任务索引的间隔，等于线程数
+    int nb_jobs;
+    int ret;                      ///< 第一个失败任务的错误码，没有失败时为0
+} BatchThread;
+
+/*
+ 线程使用的上下文：直接复制已经初始化好的上下文，共享滤波器系数，
+ 只重新分配描述符和切片（环形缓冲区），因为它们在缩放过程中会被修改
+*/
+static SwsContext *clone_context(SwsContext *c)
+{
+    SwsContext *t = malloc(sizeof(*t));
+
+    if (!t)
+        return NULL;
+
+    *t = *c;
+    t->desc = NULL;
+    t->slice = NULL;
+    if (ff_init_filters(t) < 0) {
+        free(t);
+        return NULL;
+    }
+    return t;
+}
+
+static int scale_job(SwsContext *c, const SwsBatchJob *job)
+{
+    return sws_scale(c, job->src, job->srcStride, 0, c->srcH, job->dst, job->dstStride);
+}
+
+// 某个任务失败后继续处理其余任务，只记录第一个错误
+static void *batch_thread(void *arg)
+{
+    BatchThread *t = arg;
+    int i, ret;
+
+    for (i = t->first; i < t->nb_jobs; i += t->step) {
+        if ((ret = scale_job(t->c, &t->jobs[i])) < 0 && !t->ret)
+            t->ret = ret;
+    }
+
+    return NULL;
+}
+
+int sws_init_batch_context(SwsBatchContext *b, SwsContext *c, int nb_threads)
+{
+    int i;
+
+    b->ctx = c;
+    b->nb_threads = FFMAX(nb_threads, 1);
+    b->workers = av_mallocz_array(b->nb_threads, sizeof(*b->workers));
+    if (!b->workers)
+        return -12;
+
+    b->workers[0] = c;
+    for (i = 1; i < b->nb_threads; i++) {
+        b->workers[i] = clone_context(c);
+        if (!b->workers[i]) {
+            sws_free_batch_context(b);
+            return -12;
+        }
+    }
+    return 0;
+}
+
+int sws_scale_batch(SwsBatchContext *b, const SwsBatchJob *jobs, int nb_jobs)
+{
+    BatchThread *threads;
+    pthread_t *tids;
+    int nb_threads = FFMIN(b->nb_threads, nb_jobs);
+    int i, ret = 0;
+
+    if (nb_threads <= 1) {
+        for (i = 0; i < nb_jobs; i++) {
+            int err = scale_job(b->ctx, &jobs[i]);
+            if (err < 0 && !ret)
+                ret = err;
+        }
+        return ret;
+    }
+
+    threads = av_mallocz_array(nb_threads, sizeof(*threads));
+    tids = av_mallocz_array(nb_threads, sizeof(*tids));
+    if (!threads || !tids) {
+        free(threads);
+        free(tids);
+        return -12;
+    }
+
+    for (i = 0; i < nb_threads; i++) {
+        threads[i].c = b->workers[i];
+        threads[i].jobs = jobs;
+        threads[i].first = i;
+        threads[i].step = nb_threads;
+        threads[i].nb_jobs = nb_jobs;
+    }
+
+    // 调用线程自己处理第0组任务
+    for (i = 1; i < nb_threads; i++) {
+        if (pthread_create(&tids[i], NULL, batch_thread, &threads[i])) {
+            fprintf(stderr, "sws_scale_batch: failed to create thread %d\n", i);
+            // 创建失败的那组任务留给调用线程完成
+            threads[i].c = NULL;
+        }
+    }
+    batch_thread(&threads[0]);
+    for (i = 1; i < nb_threads; i++) {
+        if (threads[i].c)
+            pthread_join(tids[i], NULL);
+        else {
+            threads[i].c = b->ctx;
+            batch_thread(&threads[i]);
+        }
+    }
+    for (i = 0; i < nb_threads && !ret; i++)
+        ret = threads[i].ret;
+
+    free(threads);
+    free(tids);
+    return ret;
+}
+
+void sws_free_batch_context(SwsBatchContext *b)
+{
+    int i;
+
+    if (!b->workers)
+        return;
+
+    // workers[0] 是调用者的上下文；其余的只拥有自己的描述符和切片，释放前把计时并入调用者的上下文
+    for (i = 1; i < b->nb_threads; i++) {
+        if (b->workers[i]) {
+            ff_add_timing(b->ctx, b->workers[i]);
+            ff_free_filters(b->workers[i]);
+            free(b->workers[i]);
+        }
+    }
+    av_freep(&b->workers);
+}
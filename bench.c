@@ -0,0 +1,343 @@
+/*
+ * 内核函数的微基准测试，make bench 编译并运行
+ * 内核函数都是 initFilter.c 中的静态函数，这里通过 sws_init_context() 选好的函数指针取得，
+ * 和实际缩放时调用的是同一个函数。每个内核在几种宽度和滤波器长度下计时：
+ * 先预热，再采样多次，每次采样连续调用若干次，报告每次调用的中位数和百分位数。
+ * 计时用 swscale_internal.h 中的 sws_read_timer()：x86 上用 rdtsc 计周期，其他平台用 clock_gettime 计纳秒。
+ * 优化级别跟随 makefile 的 CFLAGS（make clean && make OPTFLAGS=-O2 bench）。
+ *
+ * 用法：sws_bench [-cpu N] [-samples N] [名字中包含的字符串]
+ */
+#define _GNU_SOURCE     // sched_setaffinity
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "swscale_internal.h"
+
+#define WARMUP   64               ///< 计时前的预热调用次数
+#define MAX_SAMPLES 10001
+#define MAX_WIDTH 3840
+#define MAX_TAPS 16
+#define FF_ARRAY_ELEMS(a) (sizeof(a) / sizeof((a)[0]))
+
+static const int widths[] = { 320, 1280, 1920, 3840 };
+static const int htaps[]  = { 2, 4, 8, 16 };    ///< 放大、缩小到1/2、1/4、1/8时的水平滤波器长度
+static const int vtaps[]  = { 2, 4, 8 };
+
+static int nb_samples = 1001;
+static const char *pattern;
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+/*
+ 被测内核的一次调用。各内核参数不同，用一个结构把所有可能用到的缓冲区带进来，
+ 每种内核一个小的包装函数
+*/
+typedef struct BenchArgs {
+    SwsContext *c;
+    int width;
+    int taps;
+    int16_t *hfilter;             ///< width * taps 个水平系数
+    int32_t *hfilterPos;
+    uint8_t *src8;                ///< 8位或16位输入行
+    int16_t *dst16;               ///< 水平缩放的输出，19位时按int32_t使用
+    int16_t vfilter[MAX_TAPS];
+    const int16_t *vsrc[MAX_TAPS];     ///< 垂直缩放的输入行
+    const int16_t *vsrcV[MAX_TAPS];
+    uint8_t *dst8;
+    uint8_t *dstV;
+} BenchArgs;
+
+typedef void (*bench_fn)(BenchArgs *a);
+
+static void run_hscale(BenchArgs *a)
+{
+    a->c->hyScale(a->c, a->dst16, a->width, a->src8, a->hfilter, a->hfilterPos, a->taps);
+}
+
+static void run_planeX(BenchArgs *a)
+{
+    a->c->yuv2planeX(a->vfilter, a->taps, a->vsrc, a->dst8, a->width);
+}
+
+static void run_plane1(BenchArgs *a)
+{
+    a->c->yuv2plane1(a->vsrc[0], a->dst8, a->width);
+}
+
+static void run_nv12cX(BenchArgs *a)
+{
+    a->c->yuv2nv12cX(a->c, a->vfilter, a->taps, a->vsrc, a->vsrcV, a->dst8, a->width);
+}
+
+// 打包输出，亮度、色度（和alpha）使用同样长度的垂直滤波器
+static void run_packedX(BenchArgs *a)
+{
+    a->c->yuv2packedX(a->c, a->vfilter, a->vsrc, a->taps, a->vfilter, a->vsrc, a->vsrcV, a->taps,
+                      a->c->needAlpha ? a->vsrcV : NULL, a->dst8, a->width, 0);
+}
+
+static void run_toY(BenchArgs *a)
+{
+    a->c->lumToYV12(a->dst8, a->src8, a->width, a->c->input_rgb2yuv_table);
+}
+
+static void run_toUV(BenchArgs *a)
+{
+    a->c->chrToYV12(a->dst8, a->dstV, a->src8, a->width, a->c->input_rgb2yuv_table);
+}
+
+static void run_toA(BenchArgs *a)
+{
+    a->c->alpToYV12(a->dst8, a->src8, a->width, a->c->input_rgb2yuv_table);
+}
+
+// 对一个内核计时并打印一行结果
+static void bench(const char *name, bench_fn fn, BenchArgs *a)
+{
+    static uint64_t samples[MAX_SAMPLES];
+    int i, reps;
+    uint64_t t;
+
+    if (pattern && !strstr(name, pattern))
+        return;
+
+    for (i = 0; i < WARMUP; i++)
+        fn(a);
+    // 每次采样连续调用reps次，让计时器本身的开销可以忽略
+    t = sws_read_timer();
+    fn(a);
+    t = sws_read_timer() - t;
+    reps = t < 2000 ? 8 : 1;
+
+    for (i = 0; i < nb_samples; i++) {
+        t = sws_read_timer();
+        for (int r = 0; r < reps; r++)
+            fn(a);
+        samples[i] = (sws_read_timer() - t) / reps;
+    }
+    qsort(samples, nb_samples, sizeof(*samples), cmp_u64);
+
+    printf("%-20s %6d %5d %10llu %10llu %10llu %10llu %8.2f\n", name, a->width, a->taps,
+           (unsigned long long)samples[nb_samples / 2],
+           (unsigned long long)samples[nb_samples / 10],
+           (unsigned long long)samples[nb_samples * 9 / 10],
+           (unsigned long long)samples[nb_samples * 99 / 100],
+           (double)samples[nb_samples / 2] / a->width);
+}
+
+// 只为取得函数指针而初始化一个小的上下文
+static SwsContext *get_context(enum AVPixelFormat srcFormat, enum AVPixelFormat dstFormat)
+{
+    SwsContext *c = av_mallocz(sizeof(SwsContext));
+
+    if (!c)
+        return NULL;
+    c->srcW = 64;
+    c->srcH = 64;
+    c->srcFormat = srcFormat;
+    c->dstW = 32;
+    c->dstH = 32;
+    c->dstFormat = dstFormat;
+    c->flags = 2;
+    if (sws_init_context(c) < 0) {
+        sws_freeContext(c);
+        return NULL;
+    }
+    return c;
+}
+
+// 水平滤波器：输出像素i从源的 i * (srcW - taps) / width 处开始，系数之和为1 << 14
+static void fill_hfilter(BenchArgs *a, int srcW)
+{
+    for (int i = 0; i < a->width; i++) {
+        a->hfilterPos[i] = (int64_t)i * (srcW - a->taps) / a->width;
+        for (int j = 0; j < a->taps; j++)
+            a->hfilter[i * a->taps + j] = (1 << 14) / a->taps;
+    }
+}
+
+static void fill_vfilter(BenchArgs *a)
+{
+    for (int j = 0; j < a->taps; j++)
+        a->vfilter[j] = 4096 / a->taps;
+}
+
+int main(int argc, char *argv[])
+{
+    static const struct {
+        const char *name;
+        enum AVPixelFormat src, dst;
+    } hscalers[] = {
+        { "hScale8To15_c",  AV_PIX_FMT_YUV420P,   AV_PIX_FMT_YUV420P   },
+        { "hScale8To19_c",  AV_PIX_FMT_YUV420P,   AV_PIX_FMT_YUV420P16 },
+        { "hScale16To15_c", AV_PIX_FMT_YUV420P10, AV_PIX_FMT_YUV420P   },
+        { "hScale16To19_c", AV_PIX_FMT_YUV420P10, AV_PIX_FMT_YUV420P16 },
+    }, nvscalers[] = {
+        { "yuv2nv12cX_c", AV_PIX_FMT_YUV420P, AV_PIX_FMT_NV12 },
+        { "yuv2p010cX_c", AV_PIX_FMT_YUV420P, AV_PIX_FMT_P010 },
+    }, packers[] = {
+        { "yuv2422X_c",         AV_PIX_FMT_YUV420P,  AV_PIX_FMT_YUYV422 },
+        { "yuv2rgb_full_X_c",   AV_PIX_FMT_YUV420P,  AV_PIX_FMT_RGB24   },
+        { "yuv2rgb_full_X_c+a", AV_PIX_FMT_YUVA420P, AV_PIX_FMT_BGRA    },  // 带alpha
+    };
+    // 同一个输出位深的单行和多行垂直缩放
+    static const struct {
+        const char *name1, *nameX;
+        enum AVPixelFormat src, dst;
+    } vscalers[] = {
+        { "yuv2plane1_8_c",  "yuv2planeX_8_c",  AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV420P   },
+        { "yuv2plane1_10_c", "yuv2planeX_10_c", AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV420P10 },
+        { "yuv2plane1_12_c", "yuv2planeX_12_c", AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV420P12 },
+        { "yuv2plane1_16_c", "yuv2planeX_16_c", AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV420P16 },
+        { "yuv2p010l1_c",    "yuv2p010lX_c",    AV_PIX_FMT_YUV420P, AV_PIX_FMT_P010      },
+    };
+    // 输入格式转换，宽度按该分量的采样宽度计
+    static const struct {
+        const char *name;
+        bench_fn fn;
+        enum AVPixelFormat src;
+    } converters[] = {
+        { "nv12ToUV_c",  run_toUV, AV_PIX_FMT_NV12    },
+        { "nv21ToUV_c",  run_toUV, AV_PIX_FMT_NV21    },
+        { "p010ToUV_c",  run_toUV, AV_PIX_FMT_P010    },
+        { "yuy2ToY_c",   run_toY,  AV_PIX_FMT_YUYV422 },
+        { "yuy2ToUV_c",  run_toUV, AV_PIX_FMT_YUYV422 },
+        { "uyvyToY_c",   run_toY,  AV_PIX_FMT_UYVY422 },
+        { "uyvyToUV_c",  run_toUV, AV_PIX_FMT_UYVY422 },
+        { "rgb24ToY_c",  run_toY,  AV_PIX_FMT_RGB24   },
+        { "rgb24ToUV_c", run_toUV, AV_PIX_FMT_RGB24   },
+        { "bgraToY_c",   run_toY,  AV_PIX_FMT_BGRA    },
+        { "bgraToUV_c",  run_toUV, AV_PIX_FMT_BGRA    },
+        { "bgraToA_c",   run_toA,  AV_PIX_FMT_BGRA    },
+    };
+    BenchArgs a = { 0 };
+    int cpu = 0, i, w, t;
+
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-cpu") && i + 1 < argc) {
+            cpu = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-samples") && i + 1 < argc) {
+            nb_samples = atoi(argv[++i]);
+            nb_samples = FFMIN(FFMAX(nb_samples, 11), MAX_SAMPLES);
+        } else {
+            pattern = argv[i];
+        }
+    }
+
+    // 固定在一个CPU上运行，避免迁移带来的抖动和计时器不同步
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) < 0)
+        fprintf(stderr, "Fail to pin to CPU %d, running unpinned\n", cpu);
+
+    // 输入按最大缩小比例准备：水平缩放最多读取 8 * MAX_WIDTH 个源像素
+    a.hfilter    = av_malloc(MAX_WIDTH * MAX_TAPS * sizeof(*a.hfilter));
+    a.hfilterPos = av_malloc(MAX_WIDTH * sizeof(*a.hfilterPos));
+    a.src8       = av_malloc(8 * MAX_WIDTH * 2 * 2);
+    a.dst16      = av_malloc(MAX_WIDTH * sizeof(int32_t));
+    a.dst8       = av_malloc(MAX_WIDTH * 4);
+    a.dstV       = av_malloc(MAX_WIDTH * 2);
+    if (!a.hfilter || !a.hfilterPos || !a.src8 || !a.dst16 || !a.dst8 || !a.dstV)
+        return -12;
+    srand(1);
+    for (i = 0; i < 8 * MAX_WIDTH * 2 * 2; i++)
+        a.src8[i] = rand();
+    for (t = 0; t < MAX_TAPS; t++) {
+        int16_t *line = av_malloc(MAX_WIDTH * sizeof(int32_t));
+        int16_t *lineV = av_malloc(MAX_WIDTH * sizeof(int32_t));
+        if (!line || !lineV)
+            return -12;
+        // 15位中间结果的取值范围
+        for (i = 0; i < MAX_WIDTH * 2; i++) {
+            line[i] = rand() & 0x7fff;
+            lineV[i] = rand() & 0x7fff;
+        }
+        a.vsrc[t] = line;
+        a.vsrcV[t] = lineV;
+    }
+
+    printf("%-20s %6s %5s %10s %10s %10s %10s %8s  (%s per call, %d samples)\n",
+           "kernel", "width", "taps", "median", "p10", "p90", "p99", "/pixel", SWS_TIMER_UNIT, nb_samples);
+
+    for (i = 0; i < FF_ARRAY_ELEMS(hscalers); i++) {
+        if (!(a.c = get_context(hscalers[i].src, hscalers[i].dst)))
+            return -1;
+        for (w = 0; w < FF_ARRAY_ELEMS(widths); w++) {
+            for (t = 0; t < FF_ARRAY_ELEMS(htaps); t++) {
+                a.width = widths[w];
+                a.taps = htaps[t];
+                // 滤波器长度为2时是放大，源宽度为输出的一半；否则缩小 taps/2 倍
+                fill_hfilter(&a, a.taps == 2 ? a.width / 2 + 2 : a.width * a.taps / 2);
+                bench(hscalers[i].name, run_hscale, &a);
+            }
+        }
+        sws_freeContext(a.c);
+    }
+
+    for (i = 0; i < FF_ARRAY_ELEMS(vscalers); i++) {
+        if (!(a.c = get_context(vscalers[i].src, vscalers[i].dst)))
+            return -1;
+        for (w = 0; w < FF_ARRAY_ELEMS(widths); w++) {
+            a.width = widths[w];
+            a.taps = 1;
+            bench(vscalers[i].name1, run_plane1, &a);
+            for (t = 0; t < FF_ARRAY_ELEMS(vtaps); t++) {
+                a.taps = vtaps[t];
+                fill_vfilter(&a);
+                bench(vscalers[i].nameX, run_planeX, &a);
+            }
+        }
+        sws_freeContext(a.c);
+    }
+
+    for (i = 0; i < FF_ARRAY_ELEMS(nvscalers); i++) {
+        if (!(a.c = get_context(nvscalers[i].src, nvscalers[i].dst)))
+            return -1;
+        for (w = 0; w < FF_ARRAY_ELEMS(widths); w++) {
+            for (t = 0; t < FF_ARRAY_ELEMS(vtaps); t++) {
+                a.width = widths[w] / 2;    // 色度宽度
+                a.taps = vtaps[t];
+                fill_vfilter(&a);
+                bench(nvscalers[i].name, run_nv12cX, &a);
+            }
+        }
+        sws_freeContext(a.c);
+    }
+
+    for (i = 0; i < FF_ARRAY_ELEMS(packers); i++) {
+        if (!(a.c = get_context(packers[i].src, packers[i].dst)))
+            return -1;
+        for (w = 0; w < FF_ARRAY_ELEMS(widths); w++) {
+            for (t = 0; t < FF_ARRAY_ELEMS(vtaps); t++) {
+                a.width = widths[w];
+                a.taps = vtaps[t];
+                fill_vfilter(&a);
+                bench(packers[i].name, run_packedX, &a);
+            }
+        }
+        sws_freeContext(a.c);
+    }
+
+    for (i = 0; i < FF_ARRAY_ELEMS(converters); i++) {
+        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(converters[i].src);
+
+        if (!(a.c = get_context(converters[i].src, AV_PIX_FMT_YUV420P)))
+            return -1;
+        for (w = 0; w < FF_ARRAY_ELEMS(widths); w++) {
+            a.width = converters[i].fn == run_toUV ? AV_CEIL_RSHIFT(widths[w], desc->log2_chroma_w) : widths[w];
+            a.taps = 0;
+            bench(converters[i].name, converters[i].fn, &a);
+        }
+        sws_freeContext(a.c);
+    }
+
+    return 0;
+}
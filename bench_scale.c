@@ -0,0 +1,242 @@
+/*
+ * 端到端缩放性能测试，make bench-scale 编译并运行
+ * 输入帧在内存中合成，不需要外部文件。每个用例完整地走一遍 sws_init_context() 和 sws_scale()，
+ * 格式（YUV420P/YUV444P/NV12/NV21）和缩放比例两两组合，输出格式与输入相同。
+ * 报告初始化时间、每秒帧数、每秒百万像素（按输出像素计）和每个输出像素读写的字节数，
+ * 可以另外写一份 JSON 结果，用来逐个提交比较。
+ *
+ * 用法：sws_bench_scale [-time 秒] [-frames N] [-json 文件] [-label 名字] [格式或尺寸中包含的字符串]
+ */
+#define _POSIX_C_SOURCE 200809L     // clock_gettime
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "swscale_internal.h"
+#include "imgutils.h"
+
+#define FF_ARRAY_ELEMS(a) (sizeof(a) / sizeof((a)[0]))
+#define STRIDE_ALIGN 64
+
+static const enum AVPixelFormat formats[] = {
+    AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV444P, AV_PIX_FMT_NV12, AV_PIX_FMT_NV21,
+};
+
+// test.sh 中九个用例用到的缩放比例（去掉重复的），以及常见的视频尺寸转换
+static const struct {
+    int srcW, srcH, dstW, dstH;
+} sizes[] = {
+    { 1920, 1088, 2560, 1472 },
+    { 1920, 1088, 1088,  720 },
+    { 1920, 1088,  100,  100 },
+    { 1920, 1088,   24,   46 },
+    {  100,  100, 3000, 3000 },
+    {  200,  200, 8342, 5480 },
+    { 3840, 2160, 1920, 1080 },
+    { 1920, 1080,  640,  360 },
+    { 1280,  720, 1920, 1080 },
+    { 1920, 1080, 3840, 2160 },
+};
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+typedef struct Image {
+    uint8_t *data[4];
+    int linesize[4];
+    size_t bytes;             ///< 有效数据的字节数，不含行尾填充
+} Image;
+
+// 按格式分配一帧，每行按 STRIDE_ALIGN 对齐，平面放在同一块内存中
+static int alloc_image(Image *img, int width, int height, enum AVPixelFormat fmt)
+{
+    int ret;
+
+    memset(img, 0, sizeof(*img));
+    if ((ret = av_image_alloc(img->data, img->linesize, width, height, fmt, STRIDE_ALIGN)) < 0)
+        return ret;
+    img->bytes = av_image_frame_size(fmt, width, height);
+    return 0;
+}
+
+// 合成输入：斜向渐变叠加少量伪随机噪声，各平面内容不同
+static void fill_image(Image *img, int width, int height, enum AVPixelFormat fmt)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(fmt);
+    uint32_t seed = 1;
+
+    for (int i = 0; i < 3 && img->data[i]; i++) {
+        int w = i ? AV_CEIL_RSHIFT(width, desc->log2_chroma_w) : width;
+        int h = i ? AV_CEIL_RSHIFT(height, desc->log2_chroma_h) : height;
+        if (i && isSemiPlanarYUV(fmt))
+            w *= 2;
+        for (int y = 0; y < h; y++) {
+            uint8_t *row = img->data[i] + (size_t)y * img->linesize[i];
+            for (int x = 0; x < w; x++) {
+                seed = seed * 1664525 + 1013904223;
+                row[x] = (x + y + i * 64 + (seed >> 28)) & 0xff;
+            }
+        }
+    }
+}
+
+typedef struct Result {
+    const char *format;
+    int srcW, srcH, dstW, dstH;
+    int frames;
+    double init_ms;           ///< 几次初始化中最快的一次
+    double fps;
+    double mpix;              ///< 每秒输出的百万像素
+    double bpp;               ///< 每个输出像素读写的字节数（输入帧加输出帧）
+} Result;
+
+static SwsContext *init_context(int srcW, int srcH, int dstW, int dstH, enum AVPixelFormat fmt)
+{
+    SwsContext *c = av_mallocz(sizeof(SwsContext));
+
+    if (!c)
+        return NULL;
+    c->srcW = srcW;
+    c->srcH = srcH;
+    c->srcFormat = fmt;
+    c->dstW = dstW;
+    c->dstH = dstH;
+    c->dstFormat = fmt;
+    c->flags = 2;
+    if (sws_init_context(c) < 0) {
+        sws_freeContext(c);
+        return NULL;
+    }
+    return c;
+}
+
+static int run_case(Result *r, enum AVPixelFormat fmt, int srcW, int srcH, int dstW, int dstH,
+                    double min_time, int min_frames)
+{
+    Image src, dst;
+    SwsContext *c = NULL;
+    double t, start;
+    int ret = -12;
+
+    if (alloc_image(&src, srcW, srcH, fmt) < 0)
+        return -12;
+    if (alloc_image(&dst, dstW, dstH, fmt) < 0)
+        goto end;
+    fill_image(&src, srcW, srcH, fmt);
+
+    // 初始化时间取三次中最快的一次，只保留最后一个上下文
+    r->init_ms = 1e9;
+    for (int i = 0; i < 3; i++) {
+        sws_freeContext(c);
+        t = now();
+        c = init_context(srcW, srcH, dstW, dstH, fmt);
+        t = now() - t;
+        if (!c) {
+            printf("Fail to init %s %dx%d -> %dx%d\n", av_pix_fmt_desc_get(fmt)->name, srcW, srcH, dstW, dstH);
+            ret = -22;
+            goto end;
+        }
+        r->init_ms = FFMIN(r->init_ms, t * 1e3);
+    }
+
+    // 先缩放一帧预热缓存和页表，再计时
+    if ((ret = sws_scale(c, (const uint8_t *const *)src.data, src.linesize, 0, srcH, dst.data, dst.linesize)) < 0)
+        goto end;
+    r->frames = 0;
+    start = now();
+    do {
+        if ((ret = sws_scale(c, (const uint8_t *const *)src.data, src.linesize, 0, srcH, dst.data, dst.linesize)) < 0)
+            goto end;
+        r->frames++;
+        t = now() - start;
+    } while (t < min_time || r->frames < min_frames);
+
+    r->format = av_pix_fmt_desc_get(fmt)->name;
+    r->srcW = srcW;
+    r->srcH = srcH;
+    r->dstW = dstW;
+    r->dstH = dstH;
+    r->fps = r->frames / t;
+    r->mpix = r->fps * dstW * dstH / 1e6;
+    r->bpp = (double)(src.bytes + dst.bytes) / ((double)dstW * dstH);
+    ret = 0;
+
+end:
+    sws_freeContext(c);
+    av_free(src.data[0]);
+    av_free(dst.data[0]);
+    return ret;
+}
+
+static void write_json(FILE *f, const char *label, const Result *res, int nb)
+{
+    fprintf(f, "{\n  \"label\": \"%s\",\n  \"results\": [\n", label ? label : "");
+    for (int i = 0; i < nb; i++) {
+        const Result *r = &res[i];
+        fprintf(f, "    { \"format\": \"%s\", \"src\": \"%dx%d\", \"dst\": \"%dx%d\", \"frames\": %d, "
+                   "\"init_ms\": %.3f, \"fps\": %.3f, \"mpix_per_s\": %.3f, \"bytes_per_pixel\": %.3f }%s\n",
+                r->format, r->srcW, r->srcH, r->dstW, r->dstH, r->frames,
+                r->init_ms, r->fps, r->mpix, r->bpp, i + 1 < nb ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+}
+
+int main(int argc, char *argv[])
+{
+    Result res[FF_ARRAY_ELEMS(formats) * FF_ARRAY_ELEMS(sizes)];
+    const char *jsonname = NULL, *label = NULL, *pattern = NULL;
+    double min_time = 0.5;
+    int min_frames = 3, nb = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-time") && i + 1 < argc) {
+            min_time = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "-frames") && i + 1 < argc) {
+            min_frames = atoi(argv[++i]);
+            min_frames = FFMAX(min_frames, 1);
+        } else if (!strcmp(argv[i], "-json") && i + 1 < argc) {
+            jsonname = argv[++i];
+        } else if (!strcmp(argv[i], "-label") && i + 1 < argc) {
+            label = argv[++i];
+        } else {
+            pattern = argv[i];
+        }
+    }
+
+    printf("%-8s %11s %11s %7s %9s %9s %9s %8s\n",
+           "format", "src", "dst", "frames", "init(ms)", "fps", "MPix/s", "B/pixel");
+    for (int s = 0; s < FF_ARRAY_ELEMS(sizes); s++) {
+        for (int f = 0; f < FF_ARRAY_ELEMS(formats); f++) {
+            char name[64];
+            Result *r = &res[nb];
+
+            snprintf(name, sizeof(name), "%s %dx%d %dx%d", av_pix_fmt_desc_get(formats[f])->name,
+                     sizes[s].srcW, sizes[s].srcH, sizes[s].dstW, sizes[s].dstH);
+            if (pattern && !strstr(name, pattern))
+                continue;
+            if (run_case(r, formats[f], sizes[s].srcW, sizes[s].srcH, sizes[s].dstW, sizes[s].dstH,
+                         min_time, min_frames) < 0)
+                return -1;
+            printf("%-8s %5dx%-5d %5dx%-5d %7d %9.3f %9.2f %9.2f %8.2f\n", r->format,
+                   r->srcW, r->srcH, r->dstW, r->dstH, r->frames, r->init_ms, r->fps, r->mpix, r->bpp);
+            fflush(stdout);
+            nb++;
+        }
+    }
+
+    if (jsonname) {
+        FILE *f = fopen(jsonname, "w");
+        if (!f) {
+            fprintf(stderr, "Fail to open %s\n", jsonname);
+            return -1;
+        }
+        write_json(f, label, res, nb);
+        fclose(f);
+    }
+    return 0;
+}
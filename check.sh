@@ -0,0 +1,338 @@
+#!/bin/bash
+# 回归测试：用 sws_pattern 合成输入，运行 test_resize，输出的MD5与 check.md5 中的参考值逐一比较
+# 不依赖外部图片，参考值由C实现生成；任何优化（SIMD、多线程、合并流水线等）都应与其逐位一致
+# 基线提交（15ed2b0）已经支持的用例另有一份由基线程序生成的参考值 check_baseline.md5，
+# 这部分输出不能因为后来的改动而变化
+#
+# 用法：./check.sh [-update | -baseline 基线的test_resize] [传给 test_resize 的其他选项，如 -threads 4]
+#   -update    重新生成 check.md5（只在有意改变输出时使用）
+#   -baseline  用基线提交编译出的 test_resize 重新生成 check_baseline.md5，只运行基线支持的用例：
+#                git worktree add /tmp/base 15ed2b0 && make -C /tmp/base && ./check.sh -baseline /tmp/base/test_resize
+
+GREEN='\033[0;32m'
+RED='\033[0;31m'
+NC='\033[0m' # No Color
+
+ROOT=$(cd "$(dirname "$0")" && pwd)
+RESIZE="$ROOT/test_resize"
+PATTERN="$ROOT/sws_pattern"
+APITEST="$ROOT/sws_apitest"
+GOLDEN="$ROOT/check.md5"
+BASE_GOLDEN="$ROOT/check_baseline.md5"
+
+update=0
+baseline=0
+if [ "$1" == "-update" ]; then
+    update=1
+    shift
+elif [ "$1" == "-baseline" ] && [ -n "$2" ]; then
+    # 基线程序只接受7个参数，不传其他选项
+    baseline=1
+    RESIZE=$(cd "$(dirname "$2")" && pwd)/$(basename "$2")
+    APITEST=
+    shift 2
+fi
+extra_opts="$@"
+[ $baseline == 1 ] && extra_opts=
+
+for bin in "$RESIZE" "$PATTERN" $APITEST; do
+    if [ ! -x "$bin" ]; then
+        echo "$bin not found, run make first"
+        exit 1
+    fi
+done
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+cd "$WORK" || exit 1
+
+FORMATS="YUV420P YUV444P NV12 NV21 YUV420P10 YUV420P12 YUV420P16 YUV444P10 P010 YUV422P NV16 YUYV422 UYVY422 RGB24 BGRA YUVA420P YUVA444P GRAY8"
+PATTERNS="gradient checker noise"
+# 源尺寸:目标尺寸，包括不缩放、整数倍放大缩小、非整数比例、宽高比改变、奇数尺寸和大倍数放大
+SIZES="96x64:96x64 96x64:192x128 96x64:48x32 96x64:70x46 96x64:24x46 75x49:33x17 40x30:400x300"
+# 基线支持的格式，基线只能做同一格式的缩放
+BASE_FORMATS="YUV420P YUV444P NV12 NV21"
+[ $baseline == 1 ] && FORMATS=$BASE_FORMATS
+
+errors=0
+
+# 生成输入（同样的参数只生成一次），输出到 in_<图案>_<格式>_<宽>x<高>[_<帧数>].raw
+gen_input() {
+    local pattern=$1 fmt=$2 w=$3 h=$4 frames=${5:-1}
+    local name="in_${pattern}_${fmt}_${w}x${h}_${frames}.raw"
+    if [ ! -f "$name" ]; then
+        "$PATTERN" $pattern $w $h $fmt "$name" -frames $frames >/dev/null || return 1
+    fi
+    echo "$name"
+}
+
+# 运行一个用例：run_case 输出文件名 输入图案 源格式 源宽 源高 目标宽 目标高 [test_resize选项...]
+run_case() {
+    local out=$1 pattern=$2 fmt=$3 w=$4 h=$5 dw=$6 dh=$7
+    shift 7
+    local in
+    in=$(gen_input $pattern $fmt $w $h) || { echo "Fail to generate $pattern $fmt ${w}x${h}"; errors=$((errors + 1)); return; }
+    if ! "$RESIZE" "$in" $w $h $fmt $dw $dh "$out" "$@" $extra_opts >/dev/null 2>&1; then
+        echo -e "${RED}$out: test_resize failed${NC}"
+        errors=$((errors + 1))
+    fi
+}
+
+# 1. 同一格式的缩放，所有格式 x 所有尺寸 x 所有图案
+for fmt in $FORMATS; do
+    for size in $SIZES; do
+        src=${size%:*}
+        dst=${size#*:}
+        for pattern in $PATTERNS; do
+            run_case "scale_${fmt}_${pattern}_${src}_${dst}.raw" $pattern $fmt ${src%x*} ${src#*x} ${dst%x*} ${dst#*x}
+        done
+    done
+done
+
+# test.sh 中的九个用例（大图、大比例放大和缩小），原来的图片换成合成的噪声
+for c in YUV444P:1920x1088:2560x1472 YUV444P:1920x1088:1088x720 YUV420P:1920x1088:2560x1472 \
+         YUV420P:1920x1088:1088x720 NV21:1920x1088:2560x1472 YUV444P:1920x1088:100x100 \
+         NV21:1920x1088:24x46 YUV420P:100x100:3000x3000 YUV420P:200x200:8342x5480; do
+    IFS=: read fmt src dst <<< "$c"
+    run_case "large_${fmt}_${src}_${dst}.raw" noise $fmt ${src%x*} ${src#*x} ${dst%x*} ${dst#*x}
+done
+
+# 基线对奇数宽高的色度尺寸向下取整，原始文件的布局与现在不同，这些用例不与基线比较
+base_outputs=$(ls $(for fmt in $BASE_FORMATS; do echo scale_${fmt}_*; done) large_* 2>/dev/null | grep -v 75x49 | sort)
+if [ $baseline == 1 ]; then
+    md5sum $base_outputs > "$BASE_GOLDEN"
+    echo "Updated $BASE_GOLDEN with $(echo "$base_outputs" | wc -l) outputs from $RESIZE"
+    [ $errors == 0 ]
+    exit
+fi
+
+# 2. 格式转换，所有源格式 x 所有目标格式，同时缩放；灰度不能转为打包格式和RGB
+for fmt in $FORMATS; do
+    for outfmt in $FORMATS; do
+        if [ $fmt == GRAY8 ] && [[ " YUYV422 UYVY422 RGB24 BGRA " == *" $outfmt "* ]]; then
+            continue
+        fi
+        run_case "convert_${fmt}_${outfmt}.raw" noise $fmt 96 64 70 46 -outfmt $outfmt
+    done
+done
+
+# 3. 命令行选项：裁剪、只处理亮度、色彩空间和范围
+for fmt in YUV420P NV12 YUV444P10 P010 YUYV422 RGB24; do
+    run_case "crop_${fmt}.raw" gradient $fmt 96 64 64 48 -crop 10:6:50:40
+done
+# 只处理亮度时输出不能是打包格式
+for fmt in YUV420P NV12 YUV444P10 P010 YUVA420P GRAY8; do
+    run_case "lumaonly_${fmt}.raw" checker $fmt 96 64 48 32 -lumaonly
+done
+for fmt in RGB24 BGRA; do
+    for cs in 601 709; do
+        for range in limited full; do
+            run_case "rgb2yuv_${fmt}_${cs}_${range}.raw" gradient $fmt 96 64 48 32 -outfmt YUV420P -colorspace $cs -range $range
+            run_case "yuv2rgb_${fmt}_${cs}_${range}.raw" gradient YUV420P 96 64 48 32 -outfmt $fmt -colorspace $cs -range $range
+        done
+    done
+done
+
+# alpha在BGRA的A字节和YUVA的alpha平面之间转换，渐变图案的alpha沿水平方向从不透明变到透明
+for fmt in YUVA420P YUVA444P; do
+    run_case "alpha_BGRA_${fmt}.raw" gradient BGRA 96 64 70 46 -outfmt $fmt
+    run_case "alpha_${fmt}_BGRA.raw" gradient $fmt 96 64 70 46 -outfmt BGRA
+done
+run_case "alpha_BGRA_BGRA.raw" gradient BGRA 96 64 70 46
+
+# 4. 多帧输入（噪声每帧不同）和Y4M输出
+for fmt in YUV420P NV21 YUV420P10; do
+    in=$(gen_input noise $fmt 96 64 5)
+    if ! "$RESIZE" "$in" 96 64 $fmt 64 40 "frames_${fmt}.raw" $extra_opts >/dev/null 2>&1; then
+        echo -e "${RED}frames_${fmt}.raw: test_resize failed${NC}"
+        errors=$((errors + 1))
+    fi
+done
+run_case "y4m_YUV420P.y4m" gradient YUV420P 96 64 48 32
+run_case "y4m_YUVA444P.y4m" checker YUVA444P 96 64 48 32
+
+# 两个文件必须逐字节相同：same 期望输出 参考输出
+same() {
+    if ! cmp -s "$1" "$2"; then
+        echo -e "${RED}$1 differs from $2${NC}"
+        errors=$((errors + 1))
+    fi
+}
+
+# 5. 库接口，输出与 test_resize 单独缩放同一输入的结果（ref_*）逐字节比较
+# 多路输出：每一路都与单独的上下文一致，NV输入共享解交错，调用者的上下文不被修改
+for fmt in YUV420P NV12 NV21 NV16 YUV444P10 P010 YUVA420P GRAY8; do
+    in=$(gen_input noise $fmt 96 64)
+    if ! "$APITEST" multi "$in" 96 64 $fmt "multi_${fmt}" 64x40 48x32 33x17 200x100 >/dev/null 2>&1; then
+        echo -e "${RED}multi_${fmt}: sws_apitest failed${NC}"
+        errors=$((errors + 1))
+        continue
+    fi
+    for size in 64x40 48x32 33x17 200x100; do
+        run_case "ref_multi_${fmt}_${size}.raw" noise $fmt 96 64 ${size%x*} ${size#*x}
+        same "multi_${fmt}_${size}.raw" "ref_multi_${fmt}_${size}.raw"
+    done
+done
+# 打包格式输入不能分平面送入各路输出，初始化必须失败
+in=$(gen_input noise YUYV422 96 64)
+if "$APITEST" multi "$in" 96 64 YUYV422 multi_YUYV422 48x32 >/dev/null 2>&1; then
+    echo -e "${RED}multi_YUYV422: packed input was not rejected${NC}"
+    errors=$((errors + 1))
+fi
+
+# 金字塔：每一层与用 test_resize 逐层缩小的结果一致，奇数尺寸向上取整，4:2:0 的色度行数也是奇数
+for fmt in YUV420P NV12 YUV444P10 P010 YUVA420P GRAY8; do
+    w=97
+    h=61
+    in=$(gen_input gradient $fmt $w $h)
+    if ! "$APITEST" pyramid "$in" $w $h $fmt "pyramid_${fmt}" 3 >/dev/null 2>&1; then
+        echo -e "${RED}pyramid_${fmt}: sws_apitest failed${NC}"
+        errors=$((errors + 1))
+        continue
+    fi
+    for k in 1 2 3; do
+        ref="ref_pyramid_${fmt}_$k.raw"
+        if ! "$RESIZE" "$in" $w $h $fmt $(((w + 1) / 2)) $(((h + 1) / 2)) "$ref" >/dev/null 2>&1; then
+            echo -e "${RED}$ref: test_resize failed${NC}"
+            errors=$((errors + 1))
+            break
+        fi
+        same "pyramid_${fmt}_$k.raw" "$ref"
+        in=$ref
+        w=$(((w + 1) / 2))
+        h=$(((h + 1) / 2))
+    done
+done
+
+# 自底向上（负跨距）的源和目标，各平面由调用者分别分配，按切片缩放
+for conv in YUV420P:YUV420P NV12:NV12 P010:P010 YUV444P10:YUV444P10 YUVA420P:YUVA420P GRAY8:GRAY8 \
+            YUYV422:YUYV422 BGRA:BGRA YUV420P:BGRA BGRA:YUVA420P RGB24:NV12; do
+    fmt=${conv%:*}
+    outfmt=${conv#*:}
+    in=$(gen_input noise $fmt 96 64)
+    if ! "$APITEST" flip "$in" 96 64 $fmt "flip_${fmt}_${outfmt}.raw" 70 46 $outfmt >/dev/null 2>&1; then
+        echo -e "${RED}flip_${fmt}_${outfmt}: sws_apitest failed${NC}"
+        errors=$((errors + 1))
+        continue
+    fi
+    run_case "ref_flip_${fmt}_${outfmt}.raw" noise $fmt 96 64 70 46 -outfmt $outfmt
+    same "flip_${fmt}_${outfmt}.raw" "ref_flip_${fmt}_${outfmt}.raw"
+done
+
+# 6. 命令行的多线程、标准输入、Y4M流和批量模式，以及批量缩放接口，结果都与逐帧单线程的输出一致
+for fmt in YUV420P NV21 YUV420P10; do
+    in=$(gen_input noise $fmt 96 64 5)
+    if "$RESIZE" "$in" 96 64 $fmt 64 40 "threads_${fmt}.raw" -threads 3 >/dev/null 2>&1; then
+        same "threads_${fmt}.raw" "frames_${fmt}.raw"
+    else
+        echo -e "${RED}threads_${fmt}.raw: test_resize failed${NC}"
+        errors=$((errors + 1))
+    fi
+    if "$RESIZE" - 96 64 $fmt 64 40 "stdin_${fmt}.raw" < "$in" >/dev/null 2>&1; then
+        same "stdin_${fmt}.raw" "frames_${fmt}.raw"
+    else
+        echo -e "${RED}stdin_${fmt}.raw: test_resize failed${NC}"
+        errors=$((errors + 1))
+    fi
+    if "$APITEST" batch "$in" 96 64 $fmt "batchapi_${fmt}.raw" 64 40 5 3 >/dev/null 2>&1; then
+        same "batchapi_${fmt}.raw" "frames_${fmt}.raw"
+    else
+        echo -e "${RED}batchapi_${fmt}.raw: sws_apitest failed${NC}"
+        errors=$((errors + 1))
+    fi
+done
+
+# 源图像缺少平面时接口必须返回错误（sws_apitest 返回1），不能崩溃，也不能当作成功
+expect_error() {
+    local name=$1
+    shift
+    "$APITEST" "$@" >/dev/null 2>&1
+    local rc=$?
+    if [ $rc != 1 ]; then
+        echo -e "${RED}$name: expected an error, sws_apitest returned $rc${NC}"
+        errors=$((errors + 1))
+    fi
+}
+for fmt in YUV420P NV12; do
+    in=$(gen_input noise $fmt 96 64 5)
+    expect_error "batchapi_drop_${fmt}" batch "$in" 96 64 $fmt batchapi_drop.raw 64 40 5 3 -drop 1
+    expect_error "batchapi_drop1_${fmt}" batch "$in" 96 64 $fmt batchapi_drop.raw 64 40 5 1 -drop 1
+done
+for fmt in YUV420P NV12 YUVA420P; do
+    in=$(gen_input noise $fmt 96 64)
+    expect_error "multi_drop_${fmt}" multi "$in" 96 64 $fmt multi_drop 64x40 48x32 -drop 1
+done
+in=$(gen_input noise YUVA420P 96 64)
+expect_error "multi_drop_YUVA420P_alpha" multi "$in" 96 64 YUVA420P multi_drop 64x40 -drop 3
+for fmt in YUV420P NV12 YUVA420P; do
+    in=$(gen_input gradient $fmt 97 61)
+    expect_error "pyramid_drop_${fmt}" pyramid "$in" 97 61 $fmt pyramid_drop 3 -drop 1
+done
+
+# Y4M从标准输入读、写到标准输出，单线程和多线程；输入是一个5帧的Y4M文件
+"$RESIZE" "$(gen_input noise YUV420P 96 64 5)" 96 64 YUV420P 80 48 y4min.y4m >/dev/null 2>&1
+for threads in 1 3; do
+    if "$RESIZE" - 48 32 - -threads $threads < y4min.y4m > "stream_${threads}.y4m" 2>/dev/null; then
+        :
+    else
+        echo -e "${RED}stream_${threads}.y4m: test_resize failed${NC}"
+        errors=$((errors + 1))
+    fi
+done
+"$RESIZE" y4min.y4m 48 32 ref_stream.y4m >/dev/null 2>&1
+same stream_1.y4m ref_stream.y4m
+same stream_3.y4m ref_stream.y4m
+
+# 批量模式：列表中的每个单帧文件缩放到输出目录中的同名文件，io_uring 和 pread/pwrite 两种读写方式
+mkdir -p batch_in batch_uring batch_sync
+: > batch_list.txt
+for i in 0 1 2 3 4 5 6 7 8; do
+    "$PATTERN" noise 96 64 NV12 batch_in/$i.raw -seed $((i + 1)) >/dev/null
+    echo batch_in/$i.raw >> batch_list.txt
+    "$RESIZE" batch_in/$i.raw 96 64 NV12 48 32 ref_batch_$i.raw >/dev/null 2>&1
+done
+for io in uring sync; do
+    if ! "$RESIZE" batch_list.txt 96 64 NV12 48 32 batch_$io -batch -io $io >/dev/null 2>&1; then
+        echo -e "${RED}batch_$io: test_resize failed${NC}"
+        errors=$((errors + 1))
+        continue
+    fi
+    for i in 0 1 2 3 4 5 6 7 8; do
+        same batch_$io/$i.raw ref_batch_$i.raw
+    done
+done
+
+outputs=$(ls scale_* convert_* crop_* lumaonly_* rgb2yuv_* yuv2rgb_* alpha_* frames_* y4m_* stream_* 2>/dev/null | sort)
+count=$(echo "$outputs" | wc -l)
+
+if [ $update == 1 ]; then
+    md5sum $outputs > "$GOLDEN"
+    echo "Updated $GOLDEN with $count outputs"
+    [ $errors == 0 ]
+    exit
+fi
+
+# 比较所有输出，check.md5 中有但没有生成的输出也算失败
+failed=$(md5sum -c "$GOLDEN" 2>/dev/null | grep -v ': OK$')
+if [ -n "$failed" ]; then
+    echo -e "${RED}$failed${NC}"
+    errors=$((errors + $(echo "$failed" | wc -l)))
+fi
+expected=$(wc -l < "$GOLDEN")
+if [ $count != $expected ]; then
+    echo -e "${RED}Generated $count outputs, $GOLDEN has $expected${NC}"
+    errors=$((errors + 1))
+fi
+# 基线支持的用例还要与基线程序的输出一致
+failed=$(md5sum -c "$BASE_GOLDEN" 2>/dev/null | grep -v ': OK$')
+if [ -n "$failed" ]; then
+    echo -e "${RED}$failed (differs from baseline)${NC}"
+    errors=$((errors + $(echo "$failed" | wc -l)))
+fi
+
+if [ $errors == 0 ]; then
+    echo -e "${GREEN}All $count outputs match${NC}"
+else
+    echo -e "${RED}$errors failures${NC}"
+    exit 1
+fi
@@ -0,0 +1,228 @@
+#define _DEFAULT_SOURCE     // syscall, MAP_POPULATE
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "fileio.h"
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+#if defined(__NR_io_uring_setup) && defined(IORING_OFF_SQ_RING)
+#define HAVE_IO_URING 1
+#else
+#define HAVE_IO_URING 0
+#endif
+
+// 同步完成请求中剩下的部分，done 为已经读写的字节数
+static ssize_t sync_rw(const FileIORequest *req, size_t done)
+{
+    while (done < req->len) {
+        ssize_t n = req->write ?
+            pwrite(req->fd, (uint8_t *)req->buf + done, req->len - done, req->offset + done) :
+            pread(req->fd, (uint8_t *)req->buf + done, req->len - done, req->offset + done);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return -errno;
+        }
+        if (n == 0)     // 读到文件末尾，返回实际读到的字节数
+            break;
+        done += n;
+    }
+    return done;
+}
+
+#if HAVE_IO_URING
+static int uring_init(FileIOContext *io, unsigned depth)
+{
+    struct io_uring_params p;
+    uint8_t *sq, *cq;
+
+    memset(&p, 0, sizeof(p));
+    io->ring_fd = syscall(__NR_io_uring_setup, depth, &p);
+    if (io->ring_fd < 0)
+        return -1;
+
+    io->entries = p.sq_entries;
+    io->sq_ring_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    io->cq_ring_len = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    io->sqes_len = p.sq_entries * sizeof(struct io_uring_sqe);
+    // 新内核上提交队列和完成队列在同一个映射中
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        if (io->cq_ring_len > io->sq_ring_len)
+            io->sq_ring_len = io->cq_ring_len;
+        io->cq_ring_len = 0;
+    }
+
+    io->sq_ring = mmap(NULL, io->sq_ring_len, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, io->ring_fd, IORING_OFF_SQ_RING);
+    if (io->sq_ring == MAP_FAILED)
+        goto fail;
+    if (io->cq_ring_len) {
+        io->cq_ring = mmap(NULL, io->cq_ring_len, PROT_READ | PROT_WRITE,
+                           MAP_SHARED | MAP_POPULATE, io->ring_fd, IORING_OFF_CQ_RING);
+        if (io->cq_ring == MAP_FAILED)
+            goto fail;
+    } else {
+        io->cq_ring = io->sq_ring;
+    }
+    io->sqes = mmap(NULL, io->sqes_len, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, io->ring_fd, IORING_OFF_SQES);
+    if (io->sqes == MAP_FAILED)
+        goto fail;
+
+    sq = io->sq_ring;
+    io->sq_head  = (unsigned *)(sq + p.sq_off.head);
+    io->sq_tail  = (unsigned *)(sq + p.sq_off.tail);
+    io->sq_mask  = (unsigned *)(sq + p.sq_off.ring_mask);
+    io->sq_array = (unsigned *)(sq + p.sq_off.array);
+    cq = io->cq_ring;
+    io->cq_head  = (unsigned *)(cq + p.cq_off.head);
+    io->cq_tail  = (unsigned *)(cq + p.cq_off.tail);
+    io->cq_mask  = (unsigned *)(cq + p.cq_off.ring_mask);
+    io->cqes     = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+    return 0;
+
+fail:
+    fileio_uninit(io);
+    return -1;
+}
+
+static int uring_submit(FileIOContext *io, FileIORequest *reqs, int nb_reqs)
+{
+    unsigned tail = *io->sq_tail;
+    int i, n = 0;
+
+    for (i = 0; i < nb_reqs; i++) {
+        unsigned idx = tail & *io->sq_mask;
+        struct io_uring_sqe *sqe = &io->sqes[idx];
+
+        if (reqs[i].fd < 0)
+            continue;
+
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode    = reqs[i].write ? IORING_OP_WRITE : IORING_OP_READ;
+        sqe->fd        = reqs[i].fd;
+        sqe->addr      = (uint64_t)(uintptr_t)reqs[i].buf;
+        sqe->len       = reqs[i].len;
+        sqe->off       = reqs[i].offset;
+        sqe->user_data = (uint64_t)(uintptr_t)&reqs[i];
+        io->sq_array[idx] = idx;
+        tail++;
+        n++;
+    }
+    // 内核看到新的 tail 之前，队列项必须已经写好
+    __atomic_store_n(io->sq_tail, tail, __ATOMIC_RELEASE);
+
+    // 一次系统调用提交整批请求
+    while (n > 0) {
+        int ret = syscall(__NR_io_uring_enter, io->ring_fd, n, 0, 0, NULL, 0);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            return -errno;
+        }
+        io->inflight += ret;
+        n -= ret;
+    }
+    return 0;
+}
+
+static int uring_wait(FileIOContext *io)
+{
+    while (io->inflight) {
+        unsigned head = *io->cq_head;
+
+        if (head == __atomic_load_n(io->cq_tail, __ATOMIC_ACQUIRE)) {
+            int n = syscall(__NR_io_uring_enter, io->ring_fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+            if (n < 0 && errno != EINTR)
+                return -errno;
+            continue;
+        }
+
+        struct io_uring_cqe *cqe = &io->cqes[head & *io->cq_mask];
+        FileIORequest *req = (FileIORequest *)(uintptr_t)cqe->user_data;
+        int res = cqe->res;
+        __atomic_store_n(io->cq_head, head + 1, __ATOMIC_RELEASE);
+        io->inflight--;
+
+        if (res == -EINVAL || res == -EOPNOTSUPP) {
+            // 老内核不支持 IORING_OP_READ/WRITE，这个请求和以后的请求都走 pread/pwrite
+            io->use_uring = 0;
+            req->result = sync_rw(req, 0);
+        } else if (res >= 0 && (size_t)res < req->len) {
+            // 只完成了一部分（写满管道、读到文件末尾等），剩下的同步完成
+            req->result = sync_rw(req, res);
+        } else {
+            req->result = res;
+        }
+    }
+    return 0;
+}
+#endif
+
+int fileio_init(FileIOContext *io, unsigned depth, int use_uring)
+{
+    memset(io, 0, sizeof(*io));
+    io->ring_fd = -1;
+#if HAVE_IO_URING
+    if (use_uring && uring_init(io, depth) == 0) {
+        io->use_uring = 1;
+        return 0;
+    }
+#endif
+    io->entries = depth;
+    return 0;
+}
+
+int fileio_submit(FileIOContext *io, FileIORequest *reqs, int nb_reqs, int write)
+{
+    int i;
+
+    if (io->inflight + nb_reqs > io->entries)
+        return -22;
+
+    for (i = 0; i < nb_reqs; i++) {
+        reqs[i].write = write;
+        reqs[i].result = reqs[i].fd < 0 ? -EBADF : 0;
+    }
+#if HAVE_IO_URING
+    if (io->use_uring)
+        return uring_submit(io, reqs, nb_reqs);
+#endif
+    for (i = 0; i < nb_reqs; i++)
+        if (reqs[i].fd >= 0)
+            reqs[i].result = sync_rw(&reqs[i], 0);
+    return 0;
+}
+
+int fileio_wait(FileIOContext *io)
+{
+#if HAVE_IO_URING
+    if (io->inflight)
+        return uring_wait(io);
+#endif
+    return 0;
+}
+
+void fileio_uninit(FileIOContext *io)
+{
+#if HAVE_IO_URING
+    if (io->sqes && io->sqes != MAP_FAILED)
+        munmap(io->sqes, io->sqes_len);
+    if (io->cq_ring && io->cq_ring != MAP_FAILED && io->cq_ring != io->sq_ring)
+        munmap(io->cq_ring, io->cq_ring_len);
+    if (io->sq_ring && io->sq_ring != MAP_FAILED)
+        munmap(io->sq_ring, io->sq_ring_len);
+#endif
+    if (io->ring_fd >= 0)
+        close(io->ring_fd);
+    memset(io, 0, sizeof(*io));
+    io->ring_fd = -1;
+}
@@ -0,0 +1,74 @@
+#include <limits.h>
+
+#include "imgutils.h"
+#include "swscale_internal.h"
+
+#define PLANE_ALIGN 64
+
+void av_image_plane_sizes(int rowBytes[4], int rows[4], enum AVPixelFormat fmt, int width, int height)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(fmt);
+    int bytes = isHighBitDepth(fmt) ? 2 : 1;                // 高位深格式每个样本两个字节
+    int chrW = AV_CEIL_RSHIFT(width, desc->log2_chroma_w);  // 色度的宽高，水平和垂直采样比相互独立
+    int chrH = AV_CEIL_RSHIFT(height, desc->log2_chroma_h);
+
+    rowBytes[0] = width * bytes;
+    rowBytes[3] = hasAlphaPlane(fmt) ? width : 0;
+    if (isPackedYUV(fmt)) {             // YUV全部交错存放在一个平面中，每两个像素4个字节
+        rowBytes[0] = chrW * 4;
+        rowBytes[1] = 0;
+        rowBytes[2] = 0;
+    } else if (isGray(fmt)) {           // 只有亮度平面
+        rowBytes[1] = 0;
+        rowBytes[2] = 0;
+    } else if (isRGB(fmt)) {            // 每个像素nb_components个字节
+        rowBytes[0] = width * desc->nb_components;
+        rowBytes[1] = 0;
+        rowBytes[2] = 0;
+    } else if (isSemiPlanarYUV(fmt)) {  // UV交错存放在一个平面中
+        rowBytes[1] = chrW * 2 * bytes;
+        rowBytes[2] = 0;
+    } else {
+        rowBytes[1] = chrW * bytes;
+        rowBytes[2] = chrW * bytes;
+    }
+    rows[0] = rows[3] = height;
+    rows[1] = rows[2] = chrH;
+}
+
+size_t av_image_frame_size(enum AVPixelFormat fmt, int width, int height)
+{
+    int rowBytes[4], rows[4];
+    size_t size = 0;
+
+    av_image_plane_sizes(rowBytes, rows, fmt, width, height);
+    for (int i = 0; i < 4; i++)
+        size += (size_t)rowBytes[i] * rows[i];
+    return size;
+}
+
+int av_image_alloc(uint8_t *data[4], int linesize[4], int width, int height,
+                   enum AVPixelFormat fmt, int align)
+{
+    int rowBytes[4], rows[4];
+    size_t offset[4], total = 0;
+    uint8_t *buf;
+
+    if (!av_pix_fmt_desc_get(fmt) || width <= 0 || height <= 0 || align <= 0)
+        return -22;
+    av_image_plane_sizes(rowBytes, rows, fmt, width, height);
+    for (int i = 0; i < 4; i++) {
+        linesize[i] = FFALIGN(rowBytes[i], align);
+        offset[i] = total;
+        total = FFALIGN(total + (size_t)linesize[i] * rows[i], PLANE_ALIGN);
+    }
+    if (total > INT_MAX)
+        return -22;
+
+    buf = av_malloc(total);
+    if (!buf)
+        return -12;
+    for (int i = 0; i < 4; i++)
+        data[i] = linesize[i] ? buf + offset[i] : NULL;
+    return total;
+}
@@ -1,5 +1,6 @@
 #include "limits.h"
 #include <inttypes.h>
+#include <stdlib.h>
 #include <math.h>
 #include <stdio.h>
 #include <string.h>
@@ -15,22 +16,155 @@ static inline void nvXXtoUV_c(uint8_t *dst1, uint8_t *dst2, const uint8_t *src,
     }
 }
 
-static void nv12ToUV_c(uint8_t *dstU, uint8_t *dstV, const uint8_t *src1, int width)
+static void nv12ToUV_c(uint8_t *dstU, uint8_t *dstV, const uint8_t *src1, int width,
+                       const int32_t *unused)
 {
     nvXXtoUV_c(dstU, dstV, src1, width);
 }
 
-static void nv21ToUV_c(uint8_t *dstU, uint8_t *dstV, const uint8_t *src1, int width)
+static void nv21ToUV_c(uint8_t *dstU, uint8_t *dstV, const uint8_t *src1, int width,
+                       const int32_t *unused)
 {
     nvXXtoUV_c(dstV, dstU, src1, width);
 }
 
+// 打包格式YUYV：Y0 U Y1 V，亮度在偶数字节
+static void yuy2ToY_c(uint8_t *dst, const uint8_t *src, int width, const int32_t *unused)
+{
+    int i;
+    for (i = 0; i < width; i++)
+        dst[i] = src[2 * i];
+}
+
+static void yuy2ToUV_c(uint8_t *dstU, uint8_t *dstV, const uint8_t *src1, int width,
+                       const int32_t *unused)
+{
+    int i;
+    for (i = 0; i < width; i++) {
+        dstU[i] = src1[4 * i + 1];
+        dstV[i] = src1[4 * i + 3];
+    }
+}
+
+// 打包格式UYVY：U Y0 V Y1，亮度在奇数字节
+static void uyvyToY_c(uint8_t *dst, const uint8_t *src, int width, const int32_t *unused)
+{
+    int i;
+    for (i = 0; i < width; i++)
+        dst[i] = src[2 * i + 1];
+}
+
+static void uyvyToUV_c(uint8_t *dstU, uint8_t *dstV, const uint8_t *src1, int width,
+                       const int32_t *unused)
+{
+    int i;
+    for (i = 0; i < width; i++) {
+        dstU[i] = src1[4 * i + 0];
+        dstV[i] = src1[4 * i + 2];
+    }
+}
+
+// P010的色度是16位的UV交错排列，只做解交错，数据在高位由水平缩放函数处理
+static void p010ToUV_c(uint8_t *dstU, uint8_t *dstV, const uint8_t *src1, int width,
+                       const int32_t *unused)
+{
+    const uint16_t *src = (const uint16_t *)src1;
+    uint16_t *dst1 = (uint16_t *)dstU;
+    uint16_t *dst2 = (uint16_t *)dstV;
+    int i;
+
+    for (i = 0; i < width; i++) {
+        dst1[i] = src[2 * i + 0];
+        dst2[i] = src[2 * i + 1];
+    }
+}
+
 static inline const uint8_t clip_uint8(int a)  //截断在 0-255之间
 {
     if (a&(~0xFF)) return (~a)>>31;
     else           return a;
 }
 
+static inline int clip_uintp2(int a, int p)  //截断在 0-(2^p-1)之间
+{
+    if (a & ~((1 << p) - 1)) return (~a) >> 31 & ((1 << p) - 1);
+    else                     return a;
+}
+
+static inline int16_t clip_int16(int a)
+{
+    if ((a + 0x8000U) & ~0xFFFF) return (a >> 31) ^ 0x7FFF;
+    else                         return a;
+}
+
+/*
+ RGB输入：每行直接转换为8位的Y和全分辨率的U、V，再交给水平缩放
+ 系数为Q15定点，由 init_rgb2yuv_coeffs() 根据矩阵和目标范围计算
+*/
+static inline void rgbToY(uint8_t *dst, const uint8_t *src, int width, const int32_t *rgb2yuv,
+                          int step, int ri, int gi, int bi)
+{
+    int32_t ry = rgb2yuv[RY_IDX], gy = rgb2yuv[GY_IDX], by = rgb2yuv[BY_IDX];
+    int32_t offset = rgb2yuv[YO_IDX] + (1 << (RGB2YUV_SHIFT - 1));
+    int i;
+
+    for (i = 0; i < width; i++) {
+        int r = src[step * i + ri];
+        int g = src[step * i + gi];
+        int b = src[step * i + bi];
+
+        dst[i] = clip_uint8((ry * r + gy * g + by * b + offset) >> RGB2YUV_SHIFT);
+    }
+}
+
+static inline void rgbToUV(uint8_t *dstU, uint8_t *dstV, const uint8_t *src, int width,
+                           const int32_t *rgb2yuv, int step, int ri, int gi, int bi)
+{
+    int32_t ru = rgb2yuv[RU_IDX], gu = rgb2yuv[GU_IDX], bu = rgb2yuv[BU_IDX];
+    int32_t rv = rgb2yuv[RV_IDX], gv = rgb2yuv[GV_IDX], bv = rgb2yuv[BV_IDX];
+    const int32_t offset = (128 << RGB2YUV_SHIFT) + (1 << (RGB2YUV_SHIFT - 1));
+    int i;
+
+    for (i = 0; i < width; i++) {
+        int r = src[step * i + ri];
+        int g = src[step * i + gi];
+        int b = src[step * i + bi];
+
+        dstU[i] = clip_uint8((ru * r + gu * g + bu * b + offset) >> RGB2YUV_SHIFT);
+        dstV[i] = clip_uint8((rv * r + gv * g + bv * b + offset) >> RGB2YUV_SHIFT);
+    }
+}
+
+static void rgb24ToY_c(uint8_t *dst, const uint8_t *src, int width, const int32_t *rgb2yuv)
+{
+    rgbToY(dst, src, width, rgb2yuv, 3, 0, 1, 2);
+}
+
+static void rgb24ToUV_c(uint8_t *dstU, uint8_t *dstV, const uint8_t *src1, int width,
+                        const int32_t *rgb2yuv)
+{
+    rgbToUV(dstU, dstV, src1, width, rgb2yuv, 3, 0, 1, 2);
+}
+
+static void bgraToY_c(uint8_t *dst, const uint8_t *src, int width, const int32_t *rgb2yuv)
+{
+    rgbToY(dst, src, width, rgb2yuv, 4, 2, 1, 0);
+}
+
+static void bgraToUV_c(uint8_t *dstU, uint8_t *dstV, const uint8_t *src1, int width,
+                       const int32_t *rgb2yuv)
+{
+    rgbToUV(dstU, dstV, src1, width, rgb2yuv, 4, 2, 1, 0);
+}
+
+// BGRA的A字节，不做颜色转换
+static void bgraToA_c(uint8_t *dst, const uint8_t *src, int width, const int32_t *rgb2yuv)
+{
+    int i;
+    for (i = 0; i < width; i++)
+        dst[i] = src[4 * i + 3];
+}
+
 static void yuv2planeX_8_c(const int16_t *filter, int filterSize,
                            const int16_t **src, uint8_t *dest, int dstW)
 {
@@ -51,13 +185,139 @@ static void yuv2plane1_8_c(const int16_t *src, uint8_t *dest, int dstW)
     }
 }
 
+/*
+ 9-14位输出，水平缩放的中间结果仍为15位
+ output_bits位的结果存入16位中（小端）
+*/
+static inline void yuv2planeX_10_c_template(const int16_t *filter, int filterSize,
+                                            const int16_t **src, uint16_t *dest, int dstW,
+                                            int output_bits)
+{
+    int shift = 11 + 16 - output_bits;
+
+    for (int i = 0; i < dstW; i++) {
+        int val = 1 << (shift - 1);
+        for (int j = 0; j < filterSize; j++)
+            val += src[j][i] * filter[j];
+
+        dest[i] = clip_uintp2(val >> shift, output_bits);
+    }
+}
+
+static inline void yuv2plane1_10_c_template(const int16_t *src, uint16_t *dest, int dstW,
+                                            int output_bits)
+{
+    int shift = 15 - output_bits;
+
+    for (int i = 0; i < dstW; i++) {
+        int val = src[i] + (1 << (shift - 1));
+        dest[i] = clip_uintp2(val >> shift, output_bits);
+    }
+}
+
+#define yuv2NBPS(bits)                                                          \
+static void yuv2plane1_ ## bits ## _c(const int16_t *src, uint8_t *dest, int dstW) \
+{                                                                               \
+    yuv2plane1_10_c_template(src, (uint16_t *)dest, dstW, bits);                \
+}                                                                               \
+static void yuv2planeX_ ## bits ## _c(const int16_t *filter, int filterSize,    \
+                                      const int16_t **src, uint8_t *dest, int dstW) \
+{                                                                               \
+    yuv2planeX_10_c_template(filter, filterSize, src, (uint16_t *)dest, dstW, bits); \
+}
+
+yuv2NBPS(10)
+yuv2NBPS(12)
+
+/*
+ 16位输出，水平缩放的中间结果为19位，存放在int32_t中
+*/
+static void yuv2plane1_16_c(const int16_t *_src, uint8_t *_dest, int dstW)
+{
+    const int32_t *src = (const int32_t *)_src;
+    uint16_t *dest = (uint16_t *)_dest;
+    int shift = 3;
+
+    for (int i = 0; i < dstW; i++) {
+        int val = src[i] + (1 << (shift - 1));
+        dest[i] = clip_uintp2(val >> shift, 16);
+    }
+}
+
+static void yuv2planeX_16_c(const int16_t *filter, int filterSize,
+                            const int16_t **_src, uint8_t *_dest, int dstW)
+{
+    const int32_t **src = (const int32_t **)_src;
+    uint16_t *dest = (uint16_t *)_dest;
+    int shift = 15;
+
+    for (int i = 0; i < dstW; i++) {
+        int val = 1 << (shift - 1);
+
+        // 19位数据乘以12位系数会超出int的范围，先减去一个常数，最后再加回来
+        val -= 0x40000000;
+        for (int j = 0; j < filterSize; j++)
+            val += src[j][i] * (unsigned)filter[j];
+
+        dest[i] = 0x8000 + clip_int16(val >> shift);
+    }
+}
+
+// P010的亮度：10位数据放在16位的高位
+static void yuv2p010l1_c(const int16_t *src, uint8_t *_dest, int dstW)
+{
+    uint16_t *dest = (uint16_t *)_dest;
+    int shift = 5;
+
+    for (int i = 0; i < dstW; i++) {
+        int val = src[i] + (1 << (shift - 1));
+        dest[i] = clip_uintp2(val >> shift, 10) << 6;
+    }
+}
+
+static void yuv2p010lX_c(const int16_t *filter, int filterSize,
+                         const int16_t **src, uint8_t *_dest, int dstW)
+{
+    uint16_t *dest = (uint16_t *)_dest;
+    int shift = 17;
+
+    for (int i = 0; i < dstW; i++) {
+        int val = 1 << (shift - 1);
+        for (int j = 0; j < filterSize; j++)
+            val += src[j][i] * filter[j];
+
+        dest[i] = clip_uintp2(val >> shift, 10) << 6;
+    }
+}
+
+static void yuv2p010cX_c(SwsContext *c, const int16_t *chrFilter, int chrFilterSize,
+                         const int16_t **chrUSrc, const int16_t **chrVSrc,
+                         uint8_t *_dest, int chrDstW)
+{
+    uint16_t *dest = (uint16_t *)_dest;
+    int shift = 17;
+
+    for (int i = 0; i < chrDstW; i++) {
+        int u = 1 << (shift - 1);
+        int v = 1 << (shift - 1);
+
+        for (int j = 0; j < chrFilterSize; j++) {
+            u += chrUSrc[j][i] * chrFilter[j];
+            v += chrVSrc[j][i] * chrFilter[j];
+        }
+
+        dest[2 * i]     = clip_uintp2(u >> shift, 10) << 6;
+        dest[2 * i + 1] = clip_uintp2(v >> shift, 10) << 6;
+    }
+}
+
 static void yuv2nv12cX_c(SwsContext *c, const int16_t *chrFilter, int chrFilterSize,
                         const int16_t **chrUSrc, const int16_t **chrVSrc,
                         uint8_t *dest, int chrDstW)
 {
     int i;
 
-    if (c->dstFormat == AV_PIX_FMT_NV12)
+    if (c->dstFormat != AV_PIX_FMT_NV21)   // NV12和NV16都是U在前
         for (i=0; i<chrDstW; i++) {
             int u = 64 << 12;
             int v = 64 << 12;
@@ -84,6 +344,181 @@ static void yuv2nv12cX_c(SwsContext *c, const int16_t *chrFilter, int chrFilterS
             dest[2*i+1]= clip_uint8(u>>19);
         }
 }
+/*
+ 打包4:2:2输出，两个亮度样本共用一组UV，亮度和色度在同一次循环中完成垂直缩放并写出
+*/
+static void yuv2422X_c(SwsContext *c, const int16_t *lumFilter,
+                       const int16_t **lumSrc, int lumFilterSize,
+                       const int16_t *chrFilter, const int16_t **chrUSrc,
+                       const int16_t **chrVSrc, int chrFilterSize,
+                       const int16_t **alpSrc, uint8_t *dest, int dstW, int y)
+{
+    const int yuyv = c->dstFormat == AV_PIX_FMT_YUYV422;
+    int i;
+
+    for (i = 0; i < ((dstW + 1) >> 1); i++) {
+        int Y1 = 1 << 18;
+        int Y2 = 1 << 18;
+        int U  = 1 << 18;
+        int V  = 1 << 18;
+        int j;
+
+        for (j = 0; j < lumFilterSize; j++) {
+            Y1 += lumSrc[j][i * 2]     * lumFilter[j];
+            Y2 += lumSrc[j][i * 2 + 1] * lumFilter[j];
+        }
+        for (j = 0; j < chrFilterSize; j++) {
+            U += chrUSrc[j][i] * chrFilter[j];
+            V += chrVSrc[j][i] * chrFilter[j];
+        }
+
+        if (yuyv) {
+            dest[4 * i + 0] = clip_uint8(Y1 >> 19);
+            dest[4 * i + 1] = clip_uint8(U  >> 19);
+            dest[4 * i + 2] = clip_uint8(Y2 >> 19);
+            dest[4 * i + 3] = clip_uint8(V  >> 19);
+        } else {
+            dest[4 * i + 0] = clip_uint8(U  >> 19);
+            dest[4 * i + 1] = clip_uint8(Y1 >> 19);
+            dest[4 * i + 2] = clip_uint8(V  >> 19);
+            dest[4 * i + 3] = clip_uint8(Y2 >> 19);
+        }
+    }
+}
+
+/*
+ RGB输出，色度不下采样，每个像素都有自己的UV
+ 垂直缩放后的Y/U/V为Q9定点，乘以Q13的系数后得到Q22的RGB，全部为定点运算
+*/
+static void yuv2rgb_full_X_c(SwsContext *c, const int16_t *lumFilter,
+                             const int16_t **lumSrc, int lumFilterSize,
+                             const int16_t *chrFilter, const int16_t **chrUSrc,
+                             const int16_t **chrVSrc, int chrFilterSize,
+                             const int16_t **alpSrc, uint8_t *dest, int dstW, int y)
+{
+    const int step = c->dstFormat == AV_PIX_FMT_BGRA ? 4 : 3;
+    int i;
+
+    for (i = 0; i < dstW; i++) {
+        int Y = 1 << 9;
+        int U = (1 << 9) - (128 << 19);
+        int V = (1 << 9) - (128 << 19);
+        int R, G, B;
+        int j;
+
+        for (j = 0; j < lumFilterSize; j++)
+            Y += lumSrc[j][i] * lumFilter[j];
+        for (j = 0; j < chrFilterSize; j++) {
+            U += chrUSrc[j][i] * chrFilter[j];
+            V += chrVSrc[j][i] * chrFilter[j];
+        }
+        Y >>= 10;
+        U >>= 10;
+        V >>= 10;
+
+        Y -= c->yuv2rgb_y_offset;
+        Y *= c->yuv2rgb_y_coeff;
+        Y += 1 << 21;
+        R = (unsigned)Y + V * (unsigned)c->yuv2rgb_v2r_coeff;
+        G = (unsigned)Y + V * (unsigned)c->yuv2rgb_v2g_coeff + U * (unsigned)c->yuv2rgb_u2g_coeff;
+        B = (unsigned)Y +                                      U * (unsigned)c->yuv2rgb_u2b_coeff;
+        if ((R | G | B) & 0xC0000000) {
+            R = clip_uintp2(R, 30);
+            G = clip_uintp2(G, 30);
+            B = clip_uintp2(B, 30);
+        }
+
+        if (step == 4) {
+            dest[0] = B >> 22;
+            dest[1] = G >> 22;
+            dest[2] = R >> 22;
+            if (alpSrc) {       // alpha与亮度使用同一组垂直滤波器
+                int A = 1 << 18;
+                for (j = 0; j < lumFilterSize; j++)
+                    A += alpSrc[j][i] * lumFilter[j];
+                dest[3] = clip_uint8(A >> 19);
+            } else {
+                dest[3] = 255;  // 输入没有alpha时输出不透明
+            }
+        } else {
+            dest[0] = R >> 22;
+            dest[1] = G >> 22;
+            dest[2] = B >> 22;
+        }
+        dest += step;
+    }
+}
+
+// YUV->RGB 系数 {crv, cbu, cgu, cgv}，Q16定点，对应有限范围的色度
+static const int32_t yuv2rgb_coeffs[2][4] = {
+    { 104597, 132201, 25675, 53279 },   // ITU-R BT.601
+    { 117489, 138438, 13954, 34903 },   // ITU-R BT.709
+};
+
+static int16_t roundToInt16(int64_t f)
+{
+    int r = (f + (1 << 15)) >> 16;
+
+    if (r < -0x7FFF)
+        return 0x8000;
+    else if (r > 0x7FFF)
+        return 0x7FFF;
+    else
+        return r;
+}
+
+// 根据矩阵和源范围计算YUV->RGB的定点系数
+static void init_yuv2rgb_coeffs(SwsContext *c)
+{
+    const int32_t *table = yuv2rgb_coeffs[c->colorspace == SWS_CS_ITU709];
+    int64_t crv =  table[0];
+    int64_t cbu =  table[1];
+    int64_t cgu = -table[2];
+    int64_t cgv = -table[3];
+    int64_t cy  = 1 << 16;
+    int64_t oy  = 0;
+
+    if (!c->srcRange) {     // 有限范围：亮度 16-235 拉伸到 0-255
+        cy = (cy * 255) / 219;
+        oy = 16 << 16;
+    } else {                // 全范围：色度 0-255 对应的系数要按 224/255 缩小
+        crv = (crv * 224) / 255;
+        cbu = (cbu * 224) / 255;
+        cgu = (cgu * 224) / 255;
+        cgv = (cgv * 224) / 255;
+    }
+
+    c->yuv2rgb_y_coeff   = roundToInt16(cy  * (1 << 13));
+    c->yuv2rgb_y_offset  = roundToInt16(oy  * (1 <<  9));
+    c->yuv2rgb_v2r_coeff = roundToInt16(crv * (1 << 13));
+    c->yuv2rgb_v2g_coeff = roundToInt16(cgv * (1 << 13));
+    c->yuv2rgb_u2g_coeff = roundToInt16(cgu * (1 << 13));
+    c->yuv2rgb_u2b_coeff = roundToInt16(cbu * (1 << 13));
+}
+
+// 根据矩阵和目标范围计算RGB->YUV的定点系数，U和V的三个系数之和为0，保证灰色输入得到128
+static void init_rgb2yuv_coeffs(SwsContext *c)
+{
+    const double kr = c->colorspace == SWS_CS_ITU709 ? 0.2126 : 0.299;
+    const double kb = c->colorspace == SWS_CS_ITU709 ? 0.0722 : 0.114;
+    const double kg = 1 - kr - kb;
+    const double ys = c->dstRange ? 1.0 : 219.0 / 255;     // 有限范围亮度 16-235
+    const double cs = c->dstRange ? 1.0 : 224.0 / 255;     // 有限范围色度 16-240
+    const double one = 1 << RGB2YUV_SHIFT;
+    int32_t *t = c->input_rgb2yuv_table;
+
+    t[RY_IDX] = lrint(kr * ys * one);
+    t[GY_IDX] = lrint(kg * ys * one);
+    t[BY_IDX] = lrint(kb * ys * one);
+    t[RU_IDX] = lrint(-kr / (2 * (1 - kb)) * cs * one);
+    t[GU_IDX] = lrint(-kg / (2 * (1 - kb)) * cs * one);
+    t[BU_IDX] = -t[RU_IDX] - t[GU_IDX];
+    t[GV_IDX] = lrint(-kg / (2 * (1 - kr)) * cs * one);
+    t[BV_IDX] = lrint(-kb / (2 * (1 - kr)) * cs * one);
+    t[RV_IDX] = -t[GV_IDX] - t[BV_IDX];
+    t[YO_IDX] = c->dstRange ? 0 : 16 << RGB2YUV_SHIFT;
+}
+
 /*
 `initFilter`参数
 - **outFilter** 和 **filterPos** 用于存储生成的滤波器系数和位置信息，以便后续使用。
@@ -121,14 +556,14 @@ static int initFilter(int16_t **outFilter, int32_t **filterPos,
 
     filterSize = FFMIN(filterSize, srcW - 2);
     filterSize = FFMAX(filterSize, 1);
-    printf("filterSize: %d\n", filterSize);
+    ff_dlog("filterSize: %d\n", filterSize);
     filter = malloc(dstW * sizeof(*filter) * filterSize);//filter分配的大小为 目标图像宽度 x 8 x filtersize
 
     xDstInSrc = xInc - 1;
     for (i = 0; i < dstW; i++) {
         int xx = (xDstInSrc - (filterSize - 2) * (1LL<<16)) / (1 << 17); // 计算对应方向的坐标，filtersize的起始位置坐标
         (*filterPos)[i] = xx; // 存入位置矩阵中，代表了目标图像该位置对应的源图像坐标
-        printf("float d is :\n");
+        ff_dlog("float d is :\n");
         for (int j = 0; j < filterSize; j++) {
             int64_t d = (FFABS(((int64_t)xx * (1 << 17)) - xDstInSrc)) << 13;
             double floatd;
@@ -137,7 +572,7 @@ static int initFilter(int16_t **outFilter, int32_t **filterPos,
             if (xInc > 1 << 16) // 下采样
                 d = d * dstW / srcW;
             floatd = d * (1.0 / (1 << 30)); // 计算和最邻近像素位置的距离
-            printf("%f ",floatd);
+            ff_dlog("%f ",floatd);
             // 双线性插值
             coeff = (1 << 30) - d;
             if (coeff < 0)
@@ -147,11 +582,12 @@ static int initFilter(int16_t **outFilter, int32_t **filterPos,
             filter[i * filterSize + j] = coeff; // 该位置的坐标和对应位置滤波器系数之间的协方差系数存入 filter 中
             xx++;//坐标右移一位，直到filter的最后一个位置
         }
-        printf("\n");
+        ff_dlog("\n");
         xDstInSrc += 2 * xInc;
     }
 
     filter2Size = filterSize;
+#ifdef SWS_DEBUG
     printf("filter: \n");
     for (i = 0; i < dstW; i++) {
         for (int j = 0; j < filterSize; j++) {
@@ -165,6 +601,7 @@ static int initFilter(int16_t **outFilter, int32_t **filterPos,
         printf("%d ", (*filterPos)[i]);
     }
     printf("\n");
+#endif
     // 分配内存
     filter2 = malloc(dstW * sizeof(*filter2) * filter2Size);
     for (i = 0; i < dstW; i++) {
@@ -173,6 +610,7 @@ static int initFilter(int16_t **outFilter, int32_t **filterPos,
     }
     av_freep(&filter);
 
+#ifdef SWS_DEBUG
     printf("filter2: \n");
     for (i = 0; i < dstW; i++) {
         for (int j = 0; j < filter2Size; j++) {
@@ -181,6 +619,7 @@ static int initFilter(int16_t **outFilter, int32_t **filterPos,
         printf("\n");
     }
     printf("\n");
+#endif
     /* 尝试减小滤波器大小 */
     // 应用一个近似归一化的滤波器
     minFilterSize = 0;
@@ -220,6 +659,7 @@ static int initFilter(int16_t **outFilter, int32_t **filterPos,
         if (min > minFilterSize)
             minFilterSize = min;
     }
+#ifdef SWS_DEBUG
     printf("new filter2: \n");
     for (i = 0; i < dstW; i++) {
         for (int j = 0; j < filter2Size; j++) {
@@ -228,9 +668,10 @@ static int initFilter(int16_t **outFilter, int32_t **filterPos,
         printf("\n");
     }
     printf("\n");
+#endif
     // 调整滤波器大小 使得滤波器是>=minFilterSize且能被filterAlign整除的值
     filterSize = (minFilterSize + (filterAlign - 1)) & (~(filterAlign - 1));
-    printf("new filterSize: %d\n", filterSize);
+    ff_dlog("new filterSize: %d\n", filterSize);
     // 分配内存
     filter = malloc(dstW * filterSize * sizeof(*filter));
     if (!filter)
@@ -285,6 +726,7 @@ static int initFilter(int16_t **outFilter, int32_t **filterPos,
             filter[i * filterSize + srcW - 1 - (*filterPos)[i]] += acc;  //srcW - 1 - (*filterPos)[i] 这部分可能是用来计算滤波器在源图像中的位置，以确保在源图像内部进行累加操作。
         }    //表示滤波器中特定位置的值，累加上 acc
     }
+#ifdef SWS_DEBUG
     printf("new filter: \n");
     for (i = 0; i < dstW; i++) {
         for (int j = 0; j < filterSize; j++) {
@@ -297,6 +739,7 @@ static int initFilter(int16_t **outFilter, int32_t **filterPos,
         printf("%d ", (*filterPos)[i]);
     }
     printf("\n");
+#endif
     // 分配内存
     *outFilter = malloc((dstW + 3) * (*outFilterSize * sizeof(int16_t)));
     // 归一化并存储到 outFilter 中
@@ -310,7 +753,7 @@ static int initFilter(int16_t **outFilter, int32_t **filterPos,
         }
         sum = (sum + one / 2) / one;   // one是常量，水平时是2^14，垂直时是2^12 这里的技巧也是减少误差传播，和xInc的计算一样
         if (!sum) {
-            printf("SwScaler: zero vector in scaling\n");
+            fprintf(stderr, "SwScaler: zero vector in scaling\n");
             sum = 1;
         }
         for (j = 0; j < *outFilterSize; j++) {
@@ -327,6 +770,7 @@ static int initFilter(int16_t **outFilter, int32_t **filterPos,
         int k = (dstW - 1) * (*outFilterSize) + i;
         (*outFilter)[k + 1 * (*outFilterSize)] = (*outFilter)[k + 2 * (*outFilterSize)] = (*outFilter)[k + 3 * (*outFilterSize)] = (*outFilter)[k];
     }
+#ifdef SWS_DEBUG
     printf("out filter: \n");
     for (i = 0; i < dstW; i++) {
         for (int j = 0; j < *outFilterSize; j++) {
@@ -334,16 +778,117 @@ static int initFilter(int16_t **outFilter, int32_t **filterPos,
         }
         printf("\n");
     }
+#endif
     ret = 0;
 
 fail:
     if (ret < 0)
-        printf("sws: initFilter failed\n");
+        fprintf(stderr, "sws: initFilter failed\n");
     free(filter);
     free(filter2);
     return ret;
 }
 
+#define MIN_PERIOD_OUTPUTS 64  // 周期展开后至少包含的输出个数，避免周期过短时频繁调用缩放函数
+
+static int gcd(int a, int b)
+{
+    while (b) {
+        int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// 判断第i个输出的系数是否和第i-q个相同，且filterPos恰好前进了p
+static int filterRowRepeats(const int16_t *filter, const int32_t *filterPos, int filterSize,
+                            int i, int q, int p)
+{
+    return filterPos[i] == filterPos[i - q] + p &&
+           !memcmp(filter + i * filterSize, filter + (i - q) * filterSize,
+                   filterSize * sizeof(*filter));
+}
+
+/*
+ 压缩水平滤波器表
+ srcW:dstW约分为p:q后，只要xInc是精确的（没有舍入误差），系数每q个输出重复一次，filterPos每次前进p。
+ 边界处被裁剪过的系数不满足周期性，单独保存在head和tail中，其余部分只保存一个周期。
+ 压缩后的表与原表逐像素等价，输出结果完全一致。
+*/
+static int compressFilterPeriod(int16_t **filter, int32_t **filterPos, int filterSize,
+                                int xInc, int srcW, int dstW, FilterPeriod *period)
+{
+    int g = gcd(srcW, dstW);
+    int p = srcW / g;
+    int q = dstW / g;
+    int head = 0, tail = dstW, bestLen = -1;
+    int runStart, i, m, rows;
+    int16_t *newFilter;
+    int32_t *newFilterPos;
+
+    period->head   = 0;
+    period->period = dstW;
+    period->step   = 0;
+    period->tail   = dstW;
+
+    if ((int64_t)xInc * dstW != (int64_t)srcW << 16)  // xInc有舍入，系数不是严格周期的
+        return 0;
+    if (2 * q > dstW)
+        return 0;
+
+    // 找出满足 row[i] == row[i-q] 的最长连续区间，区间前后就是边界处理过的系数
+    for (i = runStart = q; i <= dstW; i++) {
+        if (i == dstW || !filterRowRepeats(*filter, *filterPos, filterSize, i, q, p)) {
+            if (i - runStart > bestLen) {
+                bestLen = i - runStart;
+                head = runStart - q;
+                tail = i;
+            }
+            runStart = i + 1;
+        }
+    }
+
+    // 周期很短时展开成m个周期，保证每次调用缩放函数处理足够多的像素
+    m = FFMAX(1, MIN_PERIOD_OUTPUTS / q);
+    m = FFMIN(m, (tail - head) / q);
+    rows = head + m * q + (dstW - tail);
+    if (rows >= dstW)
+        return 0;
+
+    newFilter    = malloc((rows + 3) * filterSize * sizeof(*newFilter));
+    newFilterPos = malloc((rows + 3) * sizeof(*newFilterPos));
+    if (!newFilter || !newFilterPos) {
+        free(newFilter);
+        free(newFilterPos);
+        return -12;
+    }
+
+    memcpy(newFilter, *filter, (head + m * q) * filterSize * sizeof(*newFilter));
+    memcpy(newFilterPos, *filterPos, (head + m * q) * sizeof(*newFilterPos));
+    memcpy(newFilter + (head + m * q) * filterSize, *filter + tail * filterSize,
+           (dstW - tail) * filterSize * sizeof(*newFilter));
+    memcpy(newFilterPos + head + m * q, *filterPos + tail, (dstW - tail) * sizeof(*newFilterPos));
+
+    // 和initFilter一样，多分配的部分用最后一个输出的值填充
+    for (i = rows; i < rows + 3; i++) {
+        newFilterPos[i] = newFilterPos[rows - 1];
+        memcpy(newFilter + i * filterSize, newFilter + (rows - 1) * filterSize,
+               filterSize * sizeof(*newFilter));
+    }
+
+    free(*filter);
+    free(*filterPos);
+    *filter    = newFilter;
+    *filterPos = newFilterPos;
+
+    period->head   = head;
+    period->period = m * q;
+    period->step   = m * p;
+    period->tail   = tail;
+    return 0;
+}
+
 // bilinear / bicubic scaling
 // 根据位置矩阵计算新像素点的像素
 static void hScale8To15_c(SwsContext *c, int16_t *dst, int dstW,
@@ -360,6 +905,94 @@ static void hScale8To15_c(SwsContext *c, int16_t *dst, int dstW,
     }
 }
 
+/*
+ 高位深输入，输出15位中间结果（输出位深<=14时使用）
+ 源数据的有效位数加上低位的填充位数（P010为6）决定右移的位数
+*/
+static void hScale16To15_c(SwsContext *c, int16_t *dst, int dstW,
+                           const uint8_t *_src, const int16_t *filter,
+                           const int32_t *filterPos, int filterSize)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(c->srcFormat);
+    const uint16_t *src = (const uint16_t *)_src;
+    int sh = desc->bpc + desc->shift - 1;
+
+    for (int i = 0; i < dstW; i++) {
+        int srcPos = filterPos[i];
+        int val    = 0;
+        for (int j = 0; j < filterSize; j++)
+            val += src[srcPos + j] * filter[filterSize * i + j];
+        // filter=14 bit, input=16 bit, output=30 bit, >> 15 makes 15 bit
+        dst[i] = FFMIN(val >> sh, (1 << 15) - 1);
+    }
+}
+
+// 8位输入，输出19位中间结果（输出位深为16时使用）
+static void hScale8To19_c(SwsContext *c, int16_t *_dst, int dstW,
+                          const uint8_t *src, const int16_t *filter,
+                          const int32_t *filterPos, int filterSize)
+{
+    int32_t *dst = (int32_t *)_dst;
+
+    for (int i = 0; i < dstW; i++) {
+        int srcPos = filterPos[i];
+        int val    = 0;
+        for (int j = 0; j < filterSize; j++)
+            val += ((int)src[srcPos + j]) * filter[filterSize * i + j];
+        dst[i] = FFMIN(val >> 3, (1 << 19) - 1);
+    }
+}
+
+// 高位深输入，输出19位中间结果（输出位深为16时使用）
+static void hScale16To19_c(SwsContext *c, int16_t *_dst, int dstW,
+                           const uint8_t *_src, const int16_t *filter,
+                           const int32_t *filterPos, int filterSize)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(c->srcFormat);
+    const uint16_t *src = (const uint16_t *)_src;
+    int32_t *dst = (int32_t *)_dst;
+    int sh = desc->bpc + desc->shift - 5;
+
+    for (int i = 0; i < dstW; i++) {
+        int srcPos = filterPos[i];
+        int val    = 0;
+        for (int j = 0; j < filterSize; j++)
+            val += src[srcPos + j] * filter[filterSize * i + j];
+        // filter=14 bit, input=16 bit, output=30 bit, >> 11 makes 19 bit
+        dst[i] = FFMIN(val >> sh, (1 << 19) - 1);
+    }
+}
+
+// 把平面中 [y, y+height) 行的前width个样本填为val，is16表示每个样本两个字节
+static void fill_plane(uint8_t *plane, int stride, int width, int y, int height, int val, int is16)
+{
+    int i, j;
+
+    plane += y * stride;
+    for (i = 0; i < height; i++) {
+        if (is16) {
+            for (j = 0; j < width; j++)
+                ((uint16_t *)plane)[j] = val;
+        } else {
+            memset(plane, val, width);
+        }
+        plane += stride;
+    }
+}
+
+// 调用描述符的process；编译时定义了SWS_TIMING时同时累计耗时和行数，否则没有任何额外开销
+#ifdef SWS_TIMING
+#define PROCESS_DESC(d, y, h) do {                      \
+        uint64_t t0 = sws_read_timer();                 \
+        (d)->process(c, (d), y, h);                     \
+        (d)->cycles += sws_read_timer() - t0;           \
+        (d)->rows += h;                                 \
+        (d)->calls++;                                   \
+    } while (0)
+#else
+#define PROCESS_DESC(d, y, h) (d)->process(c, (d), y, h)
+#endif
+
 static int swscale(SwsContext *c, const uint8_t *src[],
                    int srcStride[], int srcSliceY,
                    int srcSliceH, uint8_t *dst[], int dstStride[])
@@ -379,6 +1012,7 @@ static int swscale(SwsContext *c, const uint8_t *src[],
     yuv2planar1_fn yuv2plane1        = c->yuv2plane1;
     yuv2planarX_fn yuv2planeX        = c->yuv2planeX;
     yuv2interleavedX_fn yuv2nv12cX   = c->yuv2nv12cX;
+    yuv2packedX_fn yuv2packedX       = c->yuv2packedX;
     const int chrSrcSliceY           =                srcSliceY >> c->chrSrcVSubSample; //起始位置
     const int chrSrcSliceH           = AV_CEIL_RSHIFT(srcSliceH,   c->chrSrcVSubSample); //总行数
     int lastDstY;
@@ -405,9 +1039,40 @@ static int swscale(SwsContext *c, const uint8_t *src[],
 
     int hasLumHoles = 1;
     int hasChrHoles = 1;
+    const uint8_t *cropSrc[4];
+    const uint8_t *packedSrc[4];
+    int packedStride[4];
     srcStride[1] <<= c->vChrDrop;
     srcStride[2] <<= c->vChrDrop;
 
+    // ROI缩放：直接把指针移到区域原点，后面的处理和完整帧完全相同
+    if (c->cropW && c->cropH) {
+        const int bytes = isHighBitDepth(c->srcFormat) ? 2 : 1;
+        const int lumStep = isRGB(c->srcFormat)       ? av_pix_fmt_desc_get(c->srcFormat)->nb_components :
+                            isPackedYUV(c->srcFormat) ? 2 : bytes;
+        const int chrStep = (isSemiPlanarYUV(c->srcFormat) ? 2 : 1) * bytes;
+        const int offset[4] = {
+            c->cropY * srcStride[0] + c->cropX * lumStep,
+            (c->cropY >> c->chrSrcVSubSample) * srcStride[1] + (c->cropX >> c->chrSrcHSubSample) * chrStep,
+            (c->cropY >> c->chrSrcVSubSample) * srcStride[2] + (c->cropX >> c->chrSrcHSubSample) * bytes,
+            c->cropY * srcStride[3] + c->cropX * bytes,
+        };
+
+        for (int i = 0; i < 4; i++)
+            cropSrc[i] = src[i] ? src[i] + offset[i] : NULL;
+        src = cropSrc;
+    }
+
+    // 打包格式只有一个平面，色度转换也从平面0读取
+    if (isPacked(c->srcFormat)) {
+        packedSrc[0] = packedSrc[1] = packedSrc[2] = src[0];
+        packedSrc[3] = NULL;
+        packedStride[0] = packedStride[1] = packedStride[2] = srcStride[0];
+        packedStride[3] = 0;
+        src = packedSrc;
+        srcStride = packedStride;
+    }
+
     /* Note the user might start scaling the picture in the middle so this
      * will not get executed. This is not really intended but works
      * currently, so people might do it. */
@@ -421,7 +1086,7 @@ static int swscale(SwsContext *c, const uint8_t *src[],
 
     lastDstY = dstY;  //最后处理的行数
     //初始化垂直缩放的函数
-    ff_init_vscale_pfn(c, yuv2plane1, yuv2planeX, yuv2nv12cX);
+    ff_init_vscale_pfn(c, yuv2plane1, yuv2planeX, yuv2nv12cX, yuv2packedX);
     //使用源图像src给src_slice中填数据
     ff_init_slice_from_src(src_slice, (uint8_t**)src, srcStride, c->srcW,
             srcSliceY, srcSliceH, chrSrcSliceY, chrSrcSliceH, 1);
@@ -449,12 +1114,13 @@ static int swscale(SwsContext *c, const uint8_t *src[],
         const int firstLumSrcY  = FFMAX(1 - vLumFilterSize, vLumFilterPos[dstY]);
         const int firstLumSrcY2 = FFMAX(1 - vLumFilterSize, vLumFilterPos[FFMIN(dstY | ((1 << c->chrDstVSubSample) - 1), dstH - 1)]);
         // First line needed as input
-        const int firstChrSrcY  = FFMAX(1 - vChrFilterSize, vChrFilterPos[chrDstY]);
+        // 只处理亮度时没有色度滤波器，色度不需要任何输入行
+        const int firstChrSrcY  = c->lumaOnly ? 0 : FFMAX(1 - vChrFilterSize, vChrFilterPos[chrDstY]);
 
         // Last line needed as input
         int lastLumSrcY  = FFMIN(c->srcH,    firstLumSrcY  + vLumFilterSize) - 1;
         int lastLumSrcY2 = FFMIN(c->srcH,    firstLumSrcY2 + vLumFilterSize) - 1;
-        int lastChrSrcY  = FFMIN(c->chrSrcH, firstChrSrcY  + vChrFilterSize) - 1;
+        int lastChrSrcY  = c->lumaOnly ? -1 : FFMIN(c->chrSrcH, firstChrSrcY  + vChrFilterSize) - 1;
         int enough_lines;
 
         int i;
@@ -494,7 +1160,7 @@ static int swscale(SwsContext *c, const uint8_t *src[],
         if (!enough_lines) {
             lastLumSrcY = srcSliceY + srcSliceH - 1;
             lastChrSrcY = chrSrcSliceY + chrSrcSliceH - 1;
-            printf("buffering slice: lastLumSrcY %d lastChrSrcY %d\n",
+            ff_dlog("buffering slice: lastLumSrcY %d lastChrSrcY %d\n",
                           lastLumSrcY, lastChrSrcY);
         }
 
@@ -520,7 +1186,7 @@ static int swscale(SwsContext *c, const uint8_t *src[],
 
         if (posY < lastLumSrcY + 1) {
             for (i = lumStart; i < lumEnd; ++i)
-                desc[i].process(c, &desc[i], firstPosY, lastPosY - firstPosY + 1);  //调用lum处理函数
+                PROCESS_DESC(&desc[i], firstPosY, lastPosY - firstPosY + 1);  //调用lum处理函数
         }
 
         lumBufIndex += lastLumSrcY - lastInLumBuf;
@@ -528,7 +1194,7 @@ static int swscale(SwsContext *c, const uint8_t *src[],
 
         if (cPosY < lastChrSrcY + 1) {
             for (i = chrStart; i < chrEnd; ++i)
-                desc[i].process(c, &desc[i], firstCPosY, lastCPosY - firstCPosY + 1);  // 调用chr处理函数
+                PROCESS_DESC(&desc[i], firstCPosY, lastCPosY - firstCPosY + 1);  // 调用chr处理函数
         }
 
         chrBufIndex += lastChrSrcY - lastInChrBuf;
@@ -543,7 +1209,27 @@ static int swscale(SwsContext *c, const uint8_t *src[],
             break;  // we can't output a dstY line so let's try with the next slice
 
         for (i = vStart; i < vEnd; ++i)
-            desc[i].process(c, &desc[i], dstY, 1);  //调用垂直缩放函数，并写入输出
+            PROCESS_DESC(&desc[i], dstY, 1);  //调用垂直缩放函数，并写入输出
+    }
+
+    // 输出有alpha平面而输入没有时，新输出的行填充为不透明
+    if (hasAlphaPlane(dstFormat) && !c->needAlpha)
+        fill_plane(dst[3], dstStride[3], dstW, lastDstY, dstY - lastDstY, 255, 0);
+
+    // 灰度输入到YUV输出时，新输出的行对应的色度填充为中性值
+    if (isGray(c->srcFormat) && !isGray(dstFormat)) {
+        const int chrY  = AV_CEIL_RSHIFT(lastDstY, c->chrDstVSubSample);
+        const int chrH  = AV_CEIL_RSHIFT(dstY, c->chrDstVSubSample) - chrY;
+        const int is16  = c->dstBpc > 8;
+        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(dstFormat);
+        const int value = (1 << (c->dstBpc - 1)) << desc->shift;
+
+        if (isSemiPlanarYUV(dstFormat)) {
+            fill_plane(dst[1], dstStride[1], 2 * c->chrDstW, chrY, chrH, value, is16);
+        } else {
+            fill_plane(dst[1], dstStride[1], c->chrDstW, chrY, chrH, value, is16);
+            fill_plane(dst[2], dstStride[2], c->chrDstW, chrY, chrH, value, is16);
+        }
     }
 
     /* store changed local vars back in the context */
@@ -556,6 +1242,100 @@ static int swscale(SwsContext *c, const uint8_t *src[],
     return dstY - lastDstY;
 }
 
+// 实际读写的平面，按位表示
+void ff_sws_used_planes(const SwsContext *c, int *srcPlanes, int *dstPlanes)
+{
+    *srcPlanes = *dstPlanes = 1;
+    // 只缩放亮度时不读输入的色度；灰度输入到YUV输出时仍然要填充输出的色度
+    if (!isPacked(c->srcFormat) && !isGray(c->srcFormat) && !c->lumaOnly)
+        *srcPlanes |= isSemiPlanarYUV(c->srcFormat) ? 2 : 6;
+    if (!isPacked(c->dstFormat) && !isGray(c->dstFormat) && (!c->lumaOnly || isGray(c->srcFormat)))
+        *dstPlanes |= isSemiPlanarYUV(c->dstFormat) ? 2 : 6;
+    if (c->needAlpha && hasAlphaPlane(c->srcFormat))
+        *srcPlanes |= 8;
+    if (hasAlphaPlane(c->dstFormat))
+        *dstPlanes |= 8;
+}
+
+/*
+ 检查缩放实际读写的平面和跨距都已给出，src 或 dst 为 NULL 时不检查对应的一侧
+ 用不到的平面不检查，可以为 NULL
+*/
+int ff_sws_check_planes(const SwsContext *c, const uint8_t *const src[], const int srcStride[],
+                        uint8_t *const dst[], const int dstStride[])
+{
+    int srcPlanes, dstPlanes;
+    int i;
+
+    ff_sws_used_planes(c, &srcPlanes, &dstPlanes);
+    for (i = 0; i < 4; i++) {
+        if (src && (srcPlanes >> i & 1) && (!src[i] || !srcStride[i])) {
+            fprintf(stderr, "sws_scale: source plane %d is missing\n", i);
+            return -22;
+        }
+        if (dst && (dstPlanes >> i & 1) && (!dst[i] || !dstStride[i])) {
+            fprintf(stderr, "sws_scale: destination plane %d is missing\n", i);
+            return -22;
+        }
+    }
+    return 0;
+}
+
+int sws_scale(SwsContext *c, const uint8_t *const srcSlice[], const int srcStride[],
+              int srcSliceY, int srcSliceH, uint8_t *const dst[], const int dstStride[])
+{
+    const uint8_t *src2[4];
+    uint8_t *dst2[4];
+    int srcStride2[4], dstStride2[4];
+    int srcPlanes, dstPlanes;
+    int i, ret;
+
+    if (srcSliceY < 0 || srcSliceH <= 0 || srcSliceY + srcSliceH > c->srcH) {
+        fprintf(stderr, "sws_scale: invalid slice %d+%d for height %d\n", srcSliceY, srcSliceH, c->srcH);
+        return -22;
+    }
+    if ((ret = ff_sws_check_planes(c, srcSlice, srcStride, dst, dstStride)) < 0)
+        return ret;
+
+    // 用不到的平面一律置空，swscale()只看到需要的平面；跨距拷贝一份，swscale()会修改它们
+    ff_sws_used_planes(c, &srcPlanes, &dstPlanes);
+    for (i = 0; i < 4; i++) {
+        src2[i]       = srcPlanes >> i & 1 ? srcSlice[i]  : NULL;
+        srcStride2[i] = srcPlanes >> i & 1 ? srcStride[i] : 0;
+        dst2[i]       = dstPlanes >> i & 1 ? dst[i]       : NULL;
+        dstStride2[i] = dstPlanes >> i & 1 ? dstStride[i] : 0;
+    }
+
+    return c->swscale(c, src2, srcStride2, srcSliceY, srcSliceH, dst2, dstStride2);
+}
+
+// 根据源像素格式选择输入转换函数
+void ff_sws_init_input_funcs(SwsContext *c)
+{
+    c->lumToYV12 = NULL;
+    c->chrToYV12 = NULL;
+    c->alpToYV12 = NULL;
+    if(c->srcFormat == AV_PIX_FMT_YUYV422) {
+        c->lumToYV12 = yuy2ToY_c;
+        c->chrToYV12 = yuy2ToUV_c;
+    } else if(c->srcFormat == AV_PIX_FMT_UYVY422) {
+        c->lumToYV12 = uyvyToY_c;
+        c->chrToYV12 = uyvyToUV_c;
+    } else if(c->srcFormat == AV_PIX_FMT_RGB24) {
+        c->lumToYV12 = rgb24ToY_c;
+        c->chrToYV12 = rgb24ToUV_c;
+    } else if(c->srcFormat == AV_PIX_FMT_BGRA) {
+        c->lumToYV12 = bgraToY_c;
+        c->chrToYV12 = bgraToUV_c;
+        c->alpToYV12 = bgraToA_c;
+    } else if(c->srcFormat == AV_PIX_FMT_NV12 || c->srcFormat == AV_PIX_FMT_NV16)
+        c->chrToYV12 = nv12ToUV_c;
+    else if(c->srcFormat == AV_PIX_FMT_NV21)
+        c->chrToYV12 = nv21ToUV_c;
+    else if(c->srcFormat == AV_PIX_FMT_P010)
+        c->chrToYV12 = p010ToUV_c;
+}
+
 // bilinear 初始化 局部参数会让运算速度变快
 int sws_init_context(SwsContext *c)
 {
@@ -572,6 +1352,38 @@ int sws_init_context(SwsContext *c)
     desc_src = av_pix_fmt_desc_get(c->srcFormat);
     desc_dst = av_pix_fmt_desc_get(c->dstFormat);
 
+    // 色度的水平和垂直采样比由格式决定，两者相互独立（例如4:2:2只在水平方向下采样）
+    c->chrSrcHSubSample = desc_src->log2_chroma_w;
+    c->chrSrcVSubSample = desc_src->log2_chroma_h;
+    c->chrDstHSubSample = desc_dst->log2_chroma_w;
+    c->chrDstVSubSample = desc_dst->log2_chroma_h;
+
+    // 灰度输入或输出时色度没有意义，只处理亮度
+    if (isGray(c->srcFormat) || isGray(c->dstFormat))
+        c->lumaOnly = 1;
+    if (c->lumaOnly && isPacked(c->dstFormat)) {
+        fprintf(stderr, "luma-only scaling cannot produce packed format %s\n", desc_dst->name);
+        return -22;
+    }
+
+    // 只缩放感兴趣区域时，后面所有的源宽高都使用区域的宽高
+    if (c->cropW || c->cropH) {
+        if (c->cropX < 0 || c->cropY < 0 || c->cropW <= 0 || c->cropH <= 0 ||
+            c->cropX + c->cropW > srcW || c->cropY + c->cropH > srcH) {
+            fprintf(stderr, "crop %d:%d:%d:%d is outside the %dx%d source\n",
+                            c->cropX, c->cropY, c->cropW, c->cropH, srcW, srcH);
+            return -22;
+        }
+        if ((c->cropX & ((1 << c->chrSrcHSubSample) - 1)) ||
+            (c->cropY & ((1 << c->chrSrcVSubSample) - 1))) {
+            fprintf(stderr, "crop origin %d:%d is not aligned to the chroma subsampling\n",
+                            c->cropX, c->cropY);
+            return -22;
+        }
+        srcW = c->srcW = c->cropW;
+        srcH = c->srcH = c->cropH;
+    }
+
     //宽和高的缩放系数
     c->lumXInc      = (((int64_t)srcW << 16) + (dstW >> 1)) / dstW;
     c->lumYInc      = (((int64_t)srcH << 16) + (dstH >> 1)) / dstH;  //添加偏移是为了减少误差累积，使得最终结果更接近于四舍五入的结果
@@ -595,12 +1407,22 @@ int sws_init_context(SwsContext *c)
                         srcW, dstW, 4, 1 << 14))                            // 源图像和目标图像的宽 对齐参数 水平常参
                          < 0)
             return -1;
-            // 水平色度滤波器参数
-        if ((ret = initFilter(&c->hChrFilter, &c->hChrFilterPos,
+            // 水平色度滤波器参数，只处理亮度时不需要
+        if (!c->lumaOnly &&
+            (ret = initFilter(&c->hChrFilter, &c->hChrFilterPos,
                         &c->hChrFilterSize, c->chrXInc,
                         c->chrSrcW, c->chrDstW, 4, 1 << 14))
                          < 0)
             return -1;
+
+        // 对于有理数缩放比例，只保留一个周期的系数
+        if ((ret = compressFilterPeriod(&c->hLumFilter, &c->hLumFilterPos, c->hLumFilterSize,
+                        c->lumXInc, srcW, dstW, &c->hLumFilterPeriod)) < 0)
+            return ret;
+        if (!c->lumaOnly &&
+            (ret = compressFilterPeriod(&c->hChrFilter, &c->hChrFilterPos, c->hChrFilterSize,
+                        c->chrXInc, c->chrSrcW, c->chrDstW, &c->hChrFilterPeriod)) < 0)
+            return ret;
     }
 
     /* precalculate vertical scaler filter coefficients 计算垂直缩放的相关系数 */
@@ -608,7 +1430,8 @@ int sws_init_context(SwsContext *c)
         if ((ret = initFilter(&c->vLumFilter, &c->vLumFilterPos, &c->vLumFilterSize,
                        c->lumYInc, srcH, dstH, 2, (1 << 12))) < 0)
             return -1;
-        if ((ret = initFilter(&c->vChrFilter, &c->vChrFilterPos, &c->vChrFilterSize,
+        if (!c->lumaOnly &&
+            (ret = initFilter(&c->vChrFilter, &c->vChrFilterPos, &c->vChrFilterSize,
                        c->chrYInc, c->chrSrcH, c->chrDstH,
                        2, (1 << 12))) < 0)
 
@@ -616,26 +1439,110 @@ int sws_init_context(SwsContext *c)
     }
 
     if(c->chrDstH > dstH){
-        printf("dstH illegal!!\n");
+        fprintf(stderr, "dstH illegal!!\n");
         return -1;
     }
     //上面是SwsContext的参数初始化
     // 初始化输出函数，这里负责将UV转为相应的格式，比如plane和交错排列的NV格式
     c->yuv2plane1 = yuv2plane1_8_c;                                         // 该函数指针主要用于仅作垂直或者水平缩放的情况
     c->yuv2planeX = yuv2planeX_8_c;                                         // 该函数在水平和垂直方向同时需要缩放的情况下调用，使用最多
-    if (c->dstFormat == AV_PIX_FMT_NV12 || c->dstFormat == AV_PIX_FMT_NV21)
+    if (c->dstFormat == AV_PIX_FMT_P010) {                                  // 高位深输出
+        c->yuv2plane1 = yuv2p010l1_c;
+        c->yuv2planeX = yuv2p010lX_c;
+    } else if (c->dstBpc == 16) {
+        c->yuv2plane1 = yuv2plane1_16_c;
+        c->yuv2planeX = yuv2planeX_16_c;
+    } else if (c->dstBpc == 12) {
+        c->yuv2plane1 = yuv2plane1_12_c;
+        c->yuv2planeX = yuv2planeX_12_c;
+    } else if (c->dstBpc == 10) {
+        c->yuv2plane1 = yuv2plane1_10_c;
+        c->yuv2planeX = yuv2planeX_10_c;
+    }
+    if (c->dstFormat == AV_PIX_FMT_P010)
+        c->yuv2nv12cX = yuv2p010cX_c;
+    else if (isSemiPlanarYUV(c->dstFormat))
         c->yuv2nv12cX = yuv2nv12cX_c;                                       //该函数主要用于将UV格式写成NV的UV交错排列方式，用于输出
+    if (isPackedYUV(c->dstFormat))
+        c->yuv2packedX = yuv2422X_c;                                        //打包格式输出，亮度和色度一起写出
+    else if (isRGB(c->dstFormat)) {
+        init_yuv2rgb_coeffs(c);
+        c->yuv2packedX = yuv2rgb_full_X_c;                                  //RGB输出，垂直缩放后直接转换颜色
+    }
 
-    c->chrToYV12 = NULL;                                                    // 初始化输入函数，主要是负责将NV12和NV21转成UV的存储方式
-    if(c->srcFormat == AV_PIX_FMT_NV12)
-        c->chrToYV12 = nv12ToUV_c;
-    else if(c->srcFormat == AV_PIX_FMT_NV21)
-        c->chrToYV12 = nv21ToUV_c;
+    if (isRGB(c->srcFormat))
+        init_rgb2yuv_coeffs(c);                                             // RGB输入在水平缩放前转换为YUV
+    ff_sws_init_input_funcs(c);                                             // 初始化输入函数，主要是负责将NV和打包格式转成平面的存储方式
 
-    c->hyScale = c->hcScale = hScale8To15_c;                                //该函数利用计算好的filter filterPos和原始图像的像素值，来计算目标图像对应位置的像素值
-    c->needs_hcscale = 1;// 都需要垂直缩放
+    // 该函数利用计算好的filter filterPos和原始图像的像素值，来计算目标图像对应位置的像素值
+    // 输出位深<=14时中间结果为15位(int16_t)，输出位深为16时为19位(int32_t)
+    if (c->srcBpc == 8)
+        c->hyScale = c->hcScale = c->dstBpc <= 14 ? hScale8To15_c : hScale8To19_c;
+    else
+        c->hyScale = c->hcScale = c->dstBpc <= 14 ? hScale16To15_c : hScale16To19_c;
+    c->needs_hcscale = !c->lumaOnly;// 只处理亮度时不需要色度水平缩放
+    if (c->lumaOnly)
+        c->chrToYV12 = NULL;                                                // 色度行不读取，也就不需要转换
+    c->needAlpha = hasAlpha(c->srcFormat) && hasAlpha(c->dstFormat);        // BGRA的A字节与alpha平面互相转换
     c->swscale = swscale;                                                   //初始化切片数据 调用计算函数进行最终的计算
 
     return ff_init_filters(c);                                              //初始化水平和垂直缩放函数
 
 }
+
+int sws_get_timing(SwsContext *c, SwsStageTiming *stages, int max_stages)
+{
+#ifdef SWS_TIMING
+    int i, n = FFMIN(c->numDesc, max_stages);
+
+    for (i = 0; i < n; i++) {
+        stages[i].name   = c->desc[i].name;
+        stages[i].cycles = c->desc[i].cycles;
+        stages[i].rows   = c->desc[i].rows;
+        stages[i].calls  = c->desc[i].calls;
+    }
+    return n;
+#else
+    return 0;
+#endif
+}
+
+void sws_reset_timing(SwsContext *c)
+{
+    int i;
+
+    for (i = 0; i < c->numDesc; i++) {
+        c->desc[i].cycles = 0;
+        c->desc[i].rows   = 0;
+        c->desc[i].calls  = 0;
+    }
+}
+
+void ff_add_timing(SwsContext *dst, const SwsContext *src)
+{
+    int i;
+
+    for (i = 0; i < FFMIN(dst->numDesc, src->numDesc); i++) {
+        dst->desc[i].cycles += src->desc[i].cycles;
+        dst->desc[i].rows   += src->desc[i].rows;
+        dst->desc[i].calls  += src->desc[i].calls;
+    }
+}
+
+// 释放sws_init_context中分配的所有内存，包括上下文本身
+void sws_freeContext(SwsContext *c)
+{
+    if (!c)
+        return;
+
+    ff_free_filters(c);
+    av_freep(&c->hLumFilter);
+    av_freep(&c->hChrFilter);
+    av_freep(&c->vLumFilter);
+    av_freep(&c->vChrFilter);
+    av_freep(&c->hLumFilterPos);
+    av_freep(&c->hChrFilterPos);
+    av_freep(&c->vLumFilterPos);
+    av_freep(&c->vChrFilterPos);
+    free(c);
+}
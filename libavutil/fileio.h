@@ -0,0 +1,58 @@
+#ifndef AVUTIL_FILEIO_H
+#define AVUTIL_FILEIO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/// 一个读或写请求，整块读写 buf 中的 len 个字节
+typedef struct FileIORequest {
+    int fd;
+    void *buf;
+    size_t len;
+    int64_t offset;               ///< 文件中的偏移
+    int write;                    ///< 由 fileio_submit() 设置
+    ssize_t result;               ///< 完成后为读写的字节数，出错为 -errno
+} FileIORequest;
+
+/**
+ * 批量文件读写。
+ * 有 io_uring 时请求一次提交给内核后立即返回，调用者可以在等待完成前做别的事情（比如缩放），
+ * 没有 io_uring（内核不支持、被禁用或编译时没有头文件）时退回到 pread/pwrite，提交时同步完成。
+ */
+typedef struct FileIOContext {
+    int use_uring;                ///< 0 表示使用 pread/pwrite
+    int ring_fd;
+    unsigned entries;             ///< 提交队列长度，同时在途的请求数不能超过它
+    unsigned inflight;            ///< 已提交还没有完成的请求数
+
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    struct io_uring_sqe *sqes;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_cqe *cqes;
+
+    void *sq_ring, *cq_ring;      ///< 映射的环形队列，用于释放
+    size_t sq_ring_len, cq_ring_len, sqes_len;
+} FileIOContext;
+
+/**
+ * 初始化
+ * @param depth     最多同时在途的请求数
+ * @param use_uring 0 表示强制使用 pread/pwrite
+ * @return 0 表示成功，负数表示错误；io_uring 不可用不算错误，此时 use_uring 被置 0
+ */
+int fileio_init(FileIOContext *io, unsigned depth, int use_uring);
+
+/**
+ * 提交一批读（write 为 0）或写请求，请求在 fileio_wait() 返回前必须保持有效
+ * fd 小于 0 的请求（比如文件没有打开）不提交，result 直接记为 -EBADF
+ * @return 0 表示成功，负数表示错误（在途请求超过 depth 等）
+ */
+int fileio_submit(FileIOContext *io, FileIORequest *reqs, int nb_reqs, int write);
+
+// 等待所有已提交的请求完成，结果写在各请求的 result 中
+int fileio_wait(FileIOContext *io);
+
+void fileio_uninit(FileIOContext *io);
+
+#endif /* AVUTIL_FILEIO_H */
@@ -0,0 +1,29 @@
+#ifndef AVUTIL_IMGUTILS_H
+#define AVUTIL_IMGUTILS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pixdesc.h"
+
+/**
+ * 按格式计算一帧各平面每行的有效字节数和行数，不存在的平面为0。
+ * 与 test_resize 读写原始文件时的帧布局一致（各平面依次存放，没有行尾填充）。
+ */
+void av_image_plane_sizes(int rowBytes[4], int rows[4], enum AVPixelFormat fmt, int width, int height);
+
+/**
+ * 一帧的有效字节数，即原始文件中一帧的大小
+ */
+size_t av_image_frame_size(enum AVPixelFormat fmt, int width, int height);
+
+/**
+ * 按格式为一帧分配缓冲区，所有平面放在一整块内存中，用 av_free(data[0]) 释放。
+ * 每个平面的起始地址按64字节对齐，每行跨距补齐到 align 字节；
+ * align 必须是2的幂，为1时跨距等于行宽，每个平面是连续的一段。内存不清零，不存在的平面为NULL。
+ * @return 分配的总字节数，负数表示错误
+ */
+int av_image_alloc(uint8_t *data[4], int linesize[4], int width, int height,
+                   enum AVPixelFormat fmt, int align);
+
+#endif /* AVUTIL_IMGUTILS_H */
@@ -4,10 +4,25 @@
 #include <inttypes.h>
 
 enum AVPixelFormat {
+    AV_PIX_FMT_NONE = -1,     ///< 未知或无效的格式
     AV_PIX_FMT_YUV420P = 0,   ///< planar YUV 4:2:0, 12bpp, (1 Cr & Cb sample per 2x2 Y samples)
     AV_PIX_FMT_YUV444P = 1,   ///< planar YUV 4:4:4, 24bpp, (1 Cr & Cb sample per 1x1 Y samples)
     AV_PIX_FMT_NV12 = 2,      ///< planar YUV 4:2:0, 12bpp, 1 plane for Y and 1 plane for the UV components, which are interleaved (first byte U and the following byte V)
     AV_PIX_FMT_NV21 = 3,      ///< as above, but U and V bytes are swapped
+    AV_PIX_FMT_YUV420P10 = 4, ///< planar YUV 4:2:0, 15bpp, (1 Cr & Cb sample per 2x2 Y samples), 10 bits per sample in 16 bits, little-endian
+    AV_PIX_FMT_YUV420P12 = 5, ///< planar YUV 4:2:0, 18bpp, (1 Cr & Cb sample per 2x2 Y samples), 12 bits per sample in 16 bits, little-endian
+    AV_PIX_FMT_YUV420P16 = 6, ///< planar YUV 4:2:0, 24bpp, (1 Cr & Cb sample per 2x2 Y samples), little-endian
+    AV_PIX_FMT_YUV444P10 = 7, ///< planar YUV 4:4:4, 30bpp, (1 Cr & Cb sample per 1x1 Y samples), 10 bits per sample in 16 bits, little-endian
+    AV_PIX_FMT_P010 = 8,      ///< like NV12, with 10bpp per component, data in the high bits, zeros in the low bits, little-endian
+    AV_PIX_FMT_YUV422P = 9,   ///< planar YUV 4:2:2, 16bpp, (1 Cr & Cb sample per 2x1 Y samples)
+    AV_PIX_FMT_NV16 = 10,     ///< interleaved chroma YUV 4:2:2, 16bpp, (1 Cr & Cb sample per 2x1 Y samples)
+    AV_PIX_FMT_YUYV422 = 11,  ///< packed YUV 4:2:2, 16bpp, Y0 Cb Y1 Cr
+    AV_PIX_FMT_UYVY422 = 12,  ///< packed YUV 4:2:2, 16bpp, Cb Y0 Cr Y1
+    AV_PIX_FMT_RGB24 = 13,    ///< packed RGB 8:8:8, 24bpp, RGBRGB...
+    AV_PIX_FMT_BGRA = 14,     ///< packed BGRA 8:8:8:8, 32bpp, BGRABGRA...
+    AV_PIX_FMT_YUVA420P = 15, ///< planar YUV 4:2:0, 20bpp, (1 Cr & Cb sample per 2x2 Y & A samples)
+    AV_PIX_FMT_YUVA444P = 16, ///< planar YUV 4:4:4 32bpp, (1 Cr & Cb sample per 1x1 Y & A samples)
+    AV_PIX_FMT_GRAY8 = 17,    ///<        Y        ,  8bpp
     AV_PIX_FMT_NB         ///< number of pixel formats, DO NOT USE THIS if you want to link with shared libav* because the number of formats might differ between versions
 };
 typedef struct AVComponentDescriptor {
@@ -74,6 +89,12 @@ typedef struct AVPixFmtDescriptor {
     //位深 一般都为8
     int bpc;
 
+    /**
+     * Number of least significant bits that must be shifted away
+     * to get the value. 例如P010的10位数据存放在16位的高位，shift为6
+     */
+    int shift;
+
     // /**
     //  * Combination of AV_PIX_FMT_FLAG_... flags.
     //  */
@@ -95,5 +116,11 @@ int av_get_bits_per_pixel(const AVPixFmtDescriptor *pixdesc);
  */
 const AVPixFmtDescriptor *av_pix_fmt_desc_get(enum AVPixelFormat pix_fmt);
 
+/**
+ * 命令行中的格式名转为枚举值，名字全部大写，如 "YUV420P"、"NV12"、"GRAY8"
+ * @return 对应的像素格式，不认识的名字返回 AV_PIX_FMT_NONE
+ */
+enum AVPixelFormat getPixelFormatFromString(const char *format);
+
 
 #endif /* AVUTIL_PIXDESC_H */
@@ -4,8 +4,10 @@
 #include <stdint.h>
 #include "pixdesc.h"    // 像素格式描述，尝试优化
 
+void *av_malloc(size_t size);
 void *av_mallocz(size_t size);
 void *av_mallocz_array(size_t nmemb, size_t size);
+void av_free(void *ptr);
 void av_freep(void *ptr);
 
 #define MAX_FILTER_SIZE 256
@@ -15,6 +17,20 @@ void av_freep(void *ptr);
 #define SWS_BITEXACT          0x80000
 #define SWS_MAX_REDUCE_CUTOFF 0.002
 
+#define SWS_CS_ITU709         1
+#define SWS_CS_ITU601         5
+#define SWS_CS_DEFAULT        5
+
+// RGB->YUV 定点系数在 input_rgb2yuv_table 中的位置
+#define RGB2YUV_SHIFT 15
+enum {
+    RY_IDX, GY_IDX, BY_IDX,
+    RU_IDX, GU_IDX, BU_IDX,
+    RV_IDX, GV_IDX, BV_IDX,
+    YO_IDX,                       ///< 亮度偏移（有限范围为16）
+    RGB2YUV_TABLE_SIZE
+};
+
 #define FFMAX(a,b) ((a) > (b) ? (a) : (b))
 #define FFMIN(a,b) ((a) > (b) ? (b) : (a))
 #define ROUNDED_DIV(a,b) (((a)>0 ? (a) + ((b)>>1) : (a) - ((b)>>1))/(b))
@@ -23,12 +39,81 @@ void av_freep(void *ptr);
 
 #define FFABS(a) ((a) >= 0 ? (a) : (-(a)))
 
+// 调试输出（滤波器系数等），只有定义了SWS_DEBUG才会打印，默认不产生任何开销
+#ifdef SWS_DEBUG
+#define ff_dlog(...) printf(__VA_ARGS__)
+#else
+#define ff_dlog(...) do { } while (0)
+#endif
+
+static inline int isSemiPlanarYUV(enum AVPixelFormat fmt)
+{
+    return fmt == AV_PIX_FMT_NV12 || fmt == AV_PIX_FMT_NV21 || fmt == AV_PIX_FMT_NV16 ||
+           fmt == AV_PIX_FMT_P010;
+}
+
+// Y和UV交错存放在同一个平面中的4:2:2打包格式
+static inline int isPackedYUV(enum AVPixelFormat fmt)
+{
+    return fmt == AV_PIX_FMT_YUYV422 || fmt == AV_PIX_FMT_UYVY422;
+}
+
+static inline int isRGB(enum AVPixelFormat fmt)
+{
+    return fmt == AV_PIX_FMT_RGB24 || fmt == AV_PIX_FMT_BGRA;
+}
+
+// 所有分量交错存放在一个平面中的格式，垂直缩放时亮度和色度一起写出
+static inline int isPacked(enum AVPixelFormat fmt)
+{
+    return isPackedYUV(fmt) || isRGB(fmt);
+}
+
+static inline int isGray(enum AVPixelFormat fmt)
+{
+    return fmt == AV_PIX_FMT_GRAY8;
+}
+
+// 带有独立alpha平面（plane 3）的平面格式
+static inline int hasAlphaPlane(enum AVPixelFormat fmt)
+{
+    return fmt == AV_PIX_FMT_YUVA420P || fmt == AV_PIX_FMT_YUVA444P;
+}
+
+// 带有alpha分量的格式：独立的alpha平面，或打包在像素中的A字节（BGRA）
+static inline int hasAlpha(enum AVPixelFormat fmt)
+{
+    return hasAlphaPlane(fmt) || fmt == AV_PIX_FMT_BGRA;
+}
+
+// 每个样本占用16位（位深大于8）的格式
+static inline int isHighBitDepth(enum AVPixelFormat fmt)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(fmt);
+    return desc && desc->bpc > 8;
+}
+
+/**
+ * 水平滤波器表的周期性描述。
+ * 当 srcW:dstW = p:q 且 16.16 的 xInc 恰好整除时，输出像素 i 与 i+q 的系数相同，
+ * filterPos 相差 p。此时只保存一个周期的系数，[head, tail) 内的输出按周期复用。
+ * 不满足条件时 head = 0, period = tail = dstW, step = 0，等价于完整的表。
+ */
+typedef struct FilterPeriod
+{
+    int head;               ///< 周期区间之前单独保存的输出个数（左边界被裁剪过的系数）
+    int period;             ///< 一个周期包含的输出个数
+    int step;               ///< 每经过一个周期 filterPos 前进的源像素个数
+    int tail;               ///< 周期区间的结束位置，[tail, dstW) 的系数接在周期之后单独保存
+} FilterPeriod;
+
 typedef struct FilterContext
 {
     uint16_t *filter;
     int *filter_pos;
     int filter_size;
     int xInc;
+    FilterPeriod period;
 } FilterContext;
 
 typedef struct VScalerContext
@@ -39,6 +124,7 @@ typedef struct VScalerContext
     void *pfn;
 } VScalerContext;
 
+struct SwsContext;      // 下面的函数指针类型在结构体定义之前就要用到
 
 typedef int (*SwsFunc)(struct SwsContext *context, const uint8_t *src[],
                        int srcStride[], int srcSliceY, int srcSliceH,
@@ -91,6 +177,29 @@ typedef void (*yuv2interleavedX_fn)(struct SwsContext *c,
                                     const int16_t **chrVSrc,
                                     uint8_t *dest, int dstW);
 
+/**
+该函数将经过水平缩放的亮度和色度数据一起写入打包输出（如YUYV），并在输入像素之间进行多点垂直缩放。
+ *
+ * @param c             SWS scaling context
+ * @param lumFilter     vertical luma scaling coefficients, 12 bits [0,4096]
+ * @param lumSrc        scaled luma (Y) source data, 15 bits
+ * @param lumFilterSize number of vertical luma input lines to scale
+ * @param chrFilter     vertical chroma scaling coefficients, 12 bits [0,4096]
+ * @param chrUSrc       scaled chroma (U) source data, 15 bits
+ * @param chrVSrc       scaled chroma (V) source data, 15 bits
+ * @param chrFilterSize number of vertical chroma input lines to scale
+ * @param alpSrc        scaled alpha (A) source data, 15 bits, same filter as luma;
+ *                      NULL if the input has no alpha
+ * @param dest          pointer to the output plane
+ * @param dstW          width of lumSrc in pixels
+ * @param y             vertical line number for this output
+ */
+typedef void (*yuv2packedX_fn)(struct SwsContext *c, const int16_t *lumFilter,
+                               const int16_t **lumSrc, int lumFilterSize,
+                               const int16_t *chrFilter, const int16_t **chrUSrc,
+                               const int16_t **chrVSrc, int chrFilterSize,
+                               const int16_t **alpSrc, uint8_t *dest, int dstW, int y);
+
 
 /* This struct should be aligned on at least a 32-byte boundary. */
 typedef struct SwsContext {
@@ -115,6 +224,37 @@ typedef struct SwsContext {
     int chrDstHSubSample;         ///< 目标图像亮度与色度平面之间水平下采样因子的二进制对数
     int chrDstVSubSample;         ///< 目标图像亮度与色度平面之间垂直下采样因子的二进制对数
     int vChrDrop;                 ///< 用户指定的源图像色度平面额外垂直下采样因子的二进制对数，一般为0
+    /**
+     * @name 源图像感兴趣区域（ROI）
+     * cropW 和 cropH 不为0时只缩放源图像中 (cropX, cropY) 开始的 cropW x cropH 区域。
+     * 调用者仍然传入完整帧的平面指针和跨距，缩放器通过跨距直接寻址区域内的行，不需要拷贝。
+     * sws_init_context() 之后 srcW/srcH 变为区域的宽高，滤波器位置也相对于区域原点计算。
+     * cropX/cropY 必须和色度下采样对齐。
+     */
+    //@{
+    int cropX;                    ///< 区域左上角在源图像中的横坐标
+    int cropY;                    ///< 区域左上角在源图像中的纵坐标
+    int cropW;                    ///< 区域宽度，0表示不裁剪
+    int cropH;                    ///< 区域高度，0表示不裁剪
+    //@}
+    /**
+     * @name YUV和RGB之间的转换
+     * colorspace 为 SWS_CS_ITU601 或 SWS_CS_ITU709，其他值按 SWS_CS_DEFAULT 处理。
+     * srcRange/dstRange 为1表示对应的YUV是全范围（0-255），为0表示有限范围（16-235）。
+     * RGB输出时使用 srcRange，RGB输入时使用 dstRange。
+     */
+    //@{
+    int colorspace;               ///< YUV和RGB转换使用的矩阵
+    int srcRange;                 ///< 源YUV是否为全范围
+    int dstRange;                 ///< 目标YUV是否为全范围
+    int yuv2rgb_y_offset;         ///< 亮度偏移，Q9定点
+    int yuv2rgb_y_coeff;          ///< 以下系数均为Q13定点
+    int yuv2rgb_v2r_coeff;
+    int yuv2rgb_v2g_coeff;
+    int yuv2rgb_u2g_coeff;
+    int yuv2rgb_u2b_coeff;
+    int32_t input_rgb2yuv_table[RGB2YUV_TABLE_SIZE]; ///< RGB输入转换系数，Q15定点
+    //@}
     int sliceDir;                 ///< 切片被馈送到缩放器的方向（1 = 自上而下，-1 = 自下而上）
 
     int numDesc;                  //滤波器描述器额个数，存储了图像宽高数据以及缩放用到的函数等
@@ -144,6 +284,8 @@ typedef struct SwsContext {
     int32_t *hChrFilterPos;       ///< 每个dst[i]的色度平面的水平滤波起始位置数组
     int32_t *vLumFilterPos;       ///< 每个dst[i]的亮度平面的垂直滤波起始位置数组
     int32_t *vChrFilterPos;       ///< 每个dst[i]的色度平面的垂直滤波起始位置数组
+    FilterPeriod hLumFilterPeriod; ///< 亮度水平滤波器表的周期布局
+    FilterPeriod hChrFilterPeriod; ///< 色度水平滤波器表的周期布局
     int hLumFilterSize;           ///< 亮度像素的水平滤波器大小
     int hChrFilterSize;           ///< 色度像素的水平滤波器大小
     int vLumFilterSize;           ///< 亮度像素的垂直滤波器大小
@@ -158,9 +300,15 @@ typedef struct SwsContext {
     yuv2planar1_fn yuv2plane1;
     yuv2planarX_fn yuv2planeX;
     yuv2interleavedX_fn yuv2nv12cX;
+    yuv2packedX_fn yuv2packedX;
 
+    /// 打包格式中提取亮度，没有缩放操作，rgb2yuv只有RGB输入时使用
+    void (*lumToYV12)(uint8_t *dst, const uint8_t *src, int width, const int32_t *rgb2yuv);
+    /// 打包格式中提取alpha，只有needAlpha且输入为BGRA时使用
+    void (*alpToYV12)(uint8_t *dst, const uint8_t *src, int width, const int32_t *rgb2yuv);
     /// 色度平面转为UV交错排列的方式，没有缩放操作
-    void (*chrToYV12)(uint8_t *dstU, uint8_t *dstV, const uint8_t *src1, int width);
+    void (*chrToYV12)(uint8_t *dstU, uint8_t *dstV, const uint8_t *src1, int width,
+                      const int32_t *rgb2yuv);
     // 水平缩放函数
     void (*hyScale)(struct SwsContext *c, int16_t *dst, int dstW,
                     const uint8_t *src, const int16_t *filter,
@@ -171,6 +319,13 @@ typedef struct SwsContext {
                     const int32_t *filterPos, int filterSize);
 
     int needs_hcscale; ///< 如果有需要转换的色度平面，则设置
+    int needAlpha;     ///< 输入和输出都有alpha（alpha平面或BGRA的A字节）时设置，alpha使用亮度滤波器缩放
+    /**
+     * 只处理亮度：不计算色度滤波器，不分配也不读写任何色度行。
+     * 调用者可以对YUV输入输出设置，此时目标的色度平面保持不变；
+     * 输入或输出为GRAY8时 sws_init_context() 会自动设置，灰度输入到YUV输出时色度填充为中性值。
+     */
+    int lumaOnly;
 
 } SwsContext;
 
@@ -209,11 +364,45 @@ typedef struct SwsFilterDescriptor
     SwsSlice *src;  ///< Source slice
     SwsSlice *dst;  ///< Output slice
     void *instance; ///< Filter instance data
+    int alpha;      ///< Flag for processing alpha channel
 
     /// Function for processing input slice sliceH lines starting from line sliceY
     int (*process)(SwsContext *c, struct SwsFilterDescriptor *desc, int sliceY, int sliceH);
+
+    const char *name;   ///< 阶段名，如 "lum hscale"，用于输出计时
+    // 以下只在编译时定义了 SWS_TIMING 时累计，见 sws_get_timing()
+    uint64_t cycles;    ///< process 累计耗时
+    int64_t rows;       ///< 累计处理的行数
+    int64_t calls;      ///< process 的调用次数
 } SwsFilterDescriptor;
 
+// 计时器，SWS_TIMING 的阶段计时和 sws_bench 共用：x86 上为rdtsc周期数，其他平台为纳秒
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define SWS_TIMER_UNIT "cycles"
+static inline uint64_t sws_read_timer(void)
+{
+    return __rdtsc();
+}
+#else
+#include <time.h>
+#define SWS_TIMER_UNIT "ns"
+static inline uint64_t sws_read_timer(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+#endif
+
+/// 描述符链中一个阶段的累计耗时，由 sws_get_timing() 填写
+typedef struct SwsStageTiming {
+    const char *name;
+    uint64_t cycles;              ///< x86上为rdtsc周期数，其他平台为纳秒
+    int64_t rows;
+    int64_t calls;
+} SwsStageTiming;
+
 // 以下是新加的
 typedef struct AVFrame {
     uint8_t *data[4];
@@ -221,7 +410,6 @@ typedef struct AVFrame {
     unsigned int height;
     unsigned int step;
     unsigned int elemSize;
-    unsigned int subsample;
 
     unsigned int linesize[4];
     int Ysize;
@@ -231,10 +419,57 @@ typedef struct AVFrame {
 
 int sws_init_context(SwsContext *c);  //初始化结构体
 
+/**
+ * 缩放一帧（或从 srcSliceY 开始的一个切片）到调用者提供的缓冲区，不经过中间拷贝。
+ * 切片是图像中连续的若干行，一帧的所有切片必须自顶向下按顺序提供。
+ * dst[] 可以指向任意内存（编码器的输入表面、memfd/共享内存的映射等），各平面不要求连续；
+ * 跨距可以为负数，此时 dst[i] 指向平面最上面一行，后面的行地址依次递减（自底向上存放），源图像同理。
+ * 格式用不到的平面可以为 NULL，src、dst 和跨距数组都不会被修改。
+ *
+ * @param c         已经调用过 sws_init_context() 的上下文
+ * @param srcSlice  源切片各平面指针，指向切片的第一行
+ * @param srcStride 源图像各平面跨距
+ * @param srcSliceY 切片第一行在源图像中的行号（从0开始）
+ * @param srcSliceH 切片的行数
+ * @param dst       目标图像各平面指针，指向整帧的第一行
+ * @param dstStride 目标图像各平面跨距
+ * @return 本次输出的行数，负数表示参数错误
+ */
+int sws_scale(SwsContext *c, const uint8_t *const srcSlice[], const int srcStride[],
+              int srcSliceY, int srcSliceH, uint8_t *const dst[], const int dstStride[]);
+
+/**
+ * 取出描述符链中每个阶段（亮度/色度格式转换、水平缩放、垂直缩放）的累计耗时和处理行数
+ * 只有编译时定义了 SWS_TIMING（make clean && make OPTFLAGS=-DSWS_TIMING）才会计时，
+ * 否则不增加任何开销，这里返回0
+ * @return 填写的阶段数，不超过 max_stages
+ */
+int sws_get_timing(SwsContext *c, SwsStageTiming *stages, int max_stages);
+
+// 计时清零，比如初始化后预热完再开始统计
+void sws_reset_timing(SwsContext *c);
+
+// 把 src 的计时累加到 dst 中，两者的描述符链必须相同（如批量缩放中线程的上下文）
+void ff_add_timing(SwsContext *dst, const SwsContext *src);
+
+// 释放上下文及其滤波器、切片等全部内存
+void sws_freeContext(SwsContext *c);
+
+// sws_scale() 实际读写的平面，按位表示（第i位对应平面i），由格式、lumaOnly 和 needAlpha 决定
+void ff_sws_used_planes(const SwsContext *c, int *srcPlanes, int *dstPlanes);
+
+// 检查用到的平面和跨距都已给出，src 或 dst 为 NULL 时跳过那一侧；缺少平面时返回 -22
+int ff_sws_check_planes(const SwsContext *c, const uint8_t *const src[], const int srcStride[],
+                        uint8_t *const dst[], const int dstStride[]);
+
+// 根据srcFormat设置输入格式转换函数（lumToYV12、chrToYV12）
+void ff_sws_init_input_funcs(SwsContext *c);
+
 
 // 将形式为 (src + width*i + j) 的输入行转换为切片格式 (line[i][j])
 // relative=true 表示第一行是 src[x][0]，否则第一行是 src[x][lum/crh Y]
-int ff_init_slice_from_src(SwsSlice * s, uint8_t *src[4], int stride[4], int srcW, int lumY, int lumH, int chrY, int chrH, int relative);
+// 跨距可以为负数；src[i] 为 NULL 的平面不存在，行指针也为 NULL
+int ff_init_slice_from_src(SwsSlice * s, uint8_t *const src[4], const int stride[4], int srcW, int lumY, int lumH, int chrY, int chrH, int relative);
 
 // 初始化缩放器滤波器描述符链
 int ff_init_filters(SwsContext *c);
@@ -251,13 +486,19 @@ int ff_rotate_slice(SwsSlice *s, int lum, int chr);
 
 
 /// 初始化亮度水平缩放描述符
-int ff_init_desc_hscale(SwsFilterDescriptor *desc, SwsSlice *src, SwsSlice *dst, uint16_t *filter, int *filter_pos, int filter_size, int xInc);
+int ff_init_desc_hscale(SwsFilterDescriptor *desc, SwsSlice *src, SwsSlice *dst, uint16_t *filter, int *filter_pos, int filter_size, int xInc, const FilterPeriod *period);
+
+/// 初始化亮度像素格式转换描述符
+int ff_init_desc_fmt_convert(SwsFilterDescriptor *desc, SwsSlice *src, SwsSlice *dst);
 
 /// 初始化色度像素格式转换描述符
 int ff_init_desc_cfmt_convert(SwsFilterDescriptor *desc, SwsSlice *src, SwsSlice *dst);
 
+/// 初始化不做色度处理的占位描述符（只处理亮度时使用）
+int ff_init_desc_no_chr(SwsFilterDescriptor *desc, SwsSlice *dst);
+
 /// 初始化色度水平缩放描述符
-int ff_init_desc_chscale(SwsFilterDescriptor *desc, SwsSlice *src, SwsSlice *dst, uint16_t *filter, int *filter_pos, int filter_size, int xInc);
+int ff_init_desc_chscale(SwsFilterDescriptor *desc, SwsSlice *src, SwsSlice *dst, uint16_t *filter, int *filter_pos, int filter_size, int xInc, const FilterPeriod *period);
 
 
 /// 初始化垂直缩放描述符
@@ -265,28 +506,127 @@ int ff_init_vscale(SwsContext *c, SwsFilterDescriptor *desc, SwsSlice *src, SwsS
 
 /// 设置垂直缩放器函数
 void ff_init_vscale_pfn(SwsContext *c, yuv2planar1_fn yuv2plane1, yuv2planarX_fn yuv2planeX,
-    yuv2interleavedX_fn yuv2nv12cX);
+    yuv2interleavedX_fn yuv2nv12cX, yuv2packedX_fn yuv2packedX);
+
 
+#define SWS_MULTI_SLICE_H 16    ///< 多路输出时每次送入各个上下文的源行数
 
 /**
- * 对 srcSlice 中的图像切片进行缩放，并将结果放入 dst 中的图像切片。
- * 切片是图像中连续行的序列。
- *
- * 必须按顺序提供切片，可以是自顶向下或自底向上的顺序。如果以非顺序方式提供切片，则函数的行为是未定义的。
- *
- * @param c         先前使用 sws_getContext() 创建的缩放上下文
- * @param srcSlice  包含源切片各平面指针的数组
- * @param srcStride 包含源图像各平面跨距的数组
- * @param srcSliceY 要处理的源图像切片的位置，即切片的第一行在图像中的位置（从零开始计数）
- * @param srcSliceH 源切片的高度，即切片中的行数
- * @param dst       包含目标图像各平面指针的数组
- * @param dstStride 包含目标图像各平面跨距的数组
- * @return          输出切片的高度
+ * 一个源图像同时缩放到多个分辨率（例如 1080p/720p/480p/360p）。
+ * 源图像按 SWS_MULTI_SLICE_H 行分块，每块依次送给所有输出的上下文，
+ * 这样每一行源数据只从内存读取一次，在所有输出之间都留在缓存中。
+ * NV12/NV21 输入的色度解交错只做一次，各输出上下文按平面格式接收色度。
+ * 不支持打包格式输入和裁剪。
+ */
+typedef struct SwsMultiContext {
+    int nb_outputs;               ///< 输出个数
+    SwsContext **outputs;         ///< 每个输出的缩放上下文，源参数必须一致，由调用者分配并设置
+    SwsContext **scalers;         ///< 实际缩放用的上下文；NV输入时是 outputs 的副本，源格式换成等价的平面格式
+    int srcW;                     ///< 源图像宽度
+    int srcH;                     ///< 源图像高度
+    enum AVPixelFormat srcFormat; ///< 源像素格式
+    int chrSrcW;                  ///< 源色度平面的宽度
+    int chrSrcVSubSample;         ///< 源图像色度垂直下采样因子的二进制对数
+
+    /// 共享的色度解交错函数，平面输入时为NULL
+    void (*chrToYV12)(uint8_t *dstU, uint8_t *dstV, const uint8_t *src1, int width,
+                      const int32_t *rgb2yuv);
+    uint8_t *chrBuf[2];           ///< 解交错后的一块U/V行
+} SwsMultiContext;
+
+/**
+ * 初始化多路输出上下文，调用前需要设置 outputs/nb_outputs，
+ * 每个 outputs[i] 的设置方式与单独调用 sws_init_context() 时相同。
+ * 调用者的上下文不会被修改：平面输入时直接初始化 outputs[i]，
+ * NV输入时只初始化按平面格式复制出的 scalers[i]，outputs[i] 只提供参数。
+ * @return 0 表示成功，负数表示错误；打包格式输入或设置了裁剪时返回 -22
+ */
+int sws_init_multi_context(SwsMultiContext *m);
+
+/**
+ * 将整帧源图像缩放到所有输出
+ * @param dst       dst[i] 为第 i 个输出的平面指针数组
+ * @param dstStride dstStride[i] 为第 i 个输出的跨距数组
+ * @return 0 表示成功，负数表示错误；缺少用到的源平面或目标平面时返回 -22，此时不写入任何输出
+ */
+int sws_scale_multi(SwsMultiContext *m, const uint8_t *const src[], const int srcStride[],
+                    uint8_t **const dst[], int *const dstStride[]);
+
+// 释放多路输出上下文以及其中的所有输出上下文
+void sws_free_multi_context(SwsMultiContext *m);
+
+#define SWS_PYRAMID_MIN_SIZE 4  ///< 金字塔最小一层的宽高下限
+
+/**
+ * 图像金字塔（1/2, 1/4, 1/8 ...）。
+ * 第 k+1 层由第 k 层按 2:1 缩放得到，而不是每层都从原图缩放。
+ * 原图按 SWS_MULTI_SLICE_H 行分块送入第一层，每层产生的新行立刻作为切片送入下一层，
+ * 整个金字塔只需对原图做一次流式遍历，上一层刚写出的行仍在缓存中。
+ */
+typedef struct SwsPyramidContext {
+    int nb_levels;                ///< 缩小的层数，不包括原图
+    SwsContext **levels;          ///< levels[k] 把第 k 层（0 为原图）缩放到第 k+1 层
+    int *levelW;                  ///< 每一层的宽度，levelW[0] 为原图宽度
+    int *levelH;                  ///< 每一层的高度，levelH[0] 为原图高度
+    int *fed;                     ///< 每一层已经送入下一层的行数
+    int chrVSubSample;            ///< 色度垂直下采样因子的二进制对数
+} SwsPyramidContext;
+
+/**
+ * 初始化金字塔，每层宽高为上一层的一半（向上取整）
+ * @return 0 表示成功，负数表示错误
+ */
+int sws_init_pyramid_context(SwsPyramidContext *p, int srcW, int srcH,
+                             enum AVPixelFormat format, int nb_levels);
+
+/**
+ * 生成整帧的金字塔
+ * @param dst       dst[k] 为第 k+1 层（1/2^(k+1)）的平面指针数组，由调用者分配
+ * @param dstStride dstStride[k] 为第 k+1 层的跨距数组
+ * @return 0 表示成功，负数表示错误；缺少用到的源平面或某一层的目标平面时返回 -22，此时不写入任何一层
+ */
+int sws_scale_pyramid(SwsPyramidContext *p, const uint8_t *const src[], const int srcStride[],
+                      uint8_t **const dst[], int *const dstStride[]);
+
+// 释放金字塔上下文以及其中的所有层
+void sws_free_pyramid_context(SwsPyramidContext *p);
+
+/// 批量缩放中的一个任务：一组源平面和一组目标平面
+typedef struct SwsBatchJob {
+    const uint8_t *src[4];        ///< 源图像各平面指针
+    int srcStride[4];             ///< 源图像各平面跨距
+    uint8_t *dst[4];              ///< 目标图像各平面指针
+    int dstStride[4];             ///< 目标图像各平面跨距
+} SwsBatchJob;
+
+/**
+ * 批量缩放大量相同尺寸的小图（缩略图等）。
+ * 所有任务共用一个已经初始化好的上下文，滤波器只计算一次；
+ * 多线程时每个线程只额外分配自己的切片和环形缓冲区，滤波器系数仍然共享。
+ */
+typedef struct SwsBatchContext {
+    SwsContext *ctx;              ///< 调用者初始化好的上下文，由调用者释放
+    int nb_threads;               ///< 线程数，1表示在调用线程中完成
+    SwsContext **workers;         ///< 每个线程使用的上下文，workers[0] 就是 ctx
+} SwsBatchContext;
+
+/**
+ * 初始化批量缩放上下文
+ * @param c          已经调用过 sws_init_context() 的上下文
+ * @param nb_threads 线程数，<= 1 时不创建线程
+ * @return 0 表示成功，负数表示错误
+ */
+int sws_init_batch_context(SwsBatchContext *b, SwsContext *c, int nb_threads);
+
+/**
+ * 缩放所有任务，每个任务都是完整的一帧
+ * 某个任务出错（比如缺少平面）时其余任务照常处理，出错任务的目标图像不会被写入
+ * @return 0 表示成功，负数是第一个出错任务的错误码
  */
-int sws_scale(struct SwsContext *c, const uint8_t *const srcSlice[],
-              const int srcStride[], int srcSliceY, int srcSliceH,
-              uint8_t *const dst[], const int dstStride[]);
+int sws_scale_batch(SwsBatchContext *b, const SwsBatchJob *jobs, int nb_jobs);
 
+// 释放批量缩放上下文中为线程分配的上下文，不释放 ctx
+void sws_free_batch_context(SwsBatchContext *b);
 
 #endif
 /* SWSCALE_SWSCALE_INTERNAL_H */
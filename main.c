@@ -3,98 +3,330 @@
 * The input include YUV and srcW 、 srcH 、dstW and dstH
 * The process of extracting YUV data from FFmpeg to pass it into `sws_init_context` should be omitted.
 */
+#define _DEFAULT_SOURCE     // MADV_SEQUENTIAL
 #include <stdlib.h>
 #include <stdio.h>
 #include <math.h>
 #include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
 #include "swscale_internal.h"
 #include "pixdesc.h"
+#include "imgutils.h"
+#include "fileio.h"
+
+
+// 一帧在文件中占用的字节数，各平面紧密排列
+static size_t frameSize(const AVFrame *frame) {
+    size_t size = frame->Ysize + frame->UVsize;
+    if (frame->linesize[2])
+        size += frame->UVsize;
+    if (frame->linesize[3])
+        size += frame->Ysize;
+    return size;
+}
+
+// YUV4MPEG2的C标记和像素格式的对应关系，同一格式的第一项用于输出
+static const struct {
+    const char *tag;
+    enum AVPixelFormat format;
+} y4mColorTags[] = {
+    { "420jpeg",  AV_PIX_FMT_YUV420P   },
+    { "420paldv", AV_PIX_FMT_YUV420P   },
+    { "420mpeg2", AV_PIX_FMT_YUV420P   },
+    { "420",      AV_PIX_FMT_YUV420P   },
+    { "422",      AV_PIX_FMT_YUV422P   },
+    { "444",      AV_PIX_FMT_YUV444P   },
+    { "444alpha", AV_PIX_FMT_YUVA444P  },
+    { "mono",     AV_PIX_FMT_GRAY8     },
+    { "420p10",   AV_PIX_FMT_YUV420P10 },
+    { "420p12",   AV_PIX_FMT_YUV420P12 },
+    { "420p16",   AV_PIX_FMT_YUV420P16 },
+    { "444p10",   AV_PIX_FMT_YUV444P10 },
+};
+
+#define Y4M_MAGIC     "YUV4MPEG2"
+#define Y4M_MAGIC_LEN 9
+
+// 输入流，输入被看作连续存放的多帧，可以是裸YUV或者YUV4MPEG2
+// 普通文件整体映射到内存，每帧只移动data[]指针；标准输入（"-"）逐帧读到调用者给的帧缓冲区
+typedef struct InputStream {
+    FILE *file;         ///< 标准输入，映射文件时为NULL
+    uint8_t *map;       ///< 文件映射区
+    size_t maplen;
+    size_t pos;         ///< 下一帧在映射区中的偏移
+    uint8_t peek[Y4M_MAGIC_LEN];  ///< 标准输入上为识别文件头已读出的字节，属于第一帧
+    size_t npeek;
+
+    int y4m;            ///< YUV4MPEG2输入，下面的字段来自文件头
+    int width;
+    int height;
+    enum AVPixelFormat format;
+    char rate[32];      ///< 帧率和像素宽高比，原样写到Y4M输出
+    char aspect[32];
+} InputStream;
+
+static void setFramePlanes(AVFrame *frame, uint8_t *base) {
+    frame->data[0] = base;
+    frame->data[1] = base + frame->Ysize;
+    frame->data[2] = base + frame->Ysize + frame->UVsize;
+    if (frame->linesize[3])  // alpha平面紧跟在V平面之后
+        frame->data[3] = frame->data[2] + frame->UVsize;
+}
 
+// 读一行文本（不含换行符），输入结束或行太长返回-1
+static int readLine(InputStream *in, char *line, int size) {
+    int n = 0, ch;
+
+    for (;;) {
+        if (in->file) {
+            if ((ch = getc(in->file)) == EOF)
+                return -1;
+        } else {
+            if (in->pos >= in->maplen)
+                return -1;
+            ch = in->map[in->pos++];
+        }
+        if (ch == '\n')
+            break;
+        if (n + 1 >= size)
+            return -1;
+        line[n++] = ch;
+    }
+    line[n] = 0;
+    return n;
+}
 
-static int readAVFrame(const char *image_yuv, AVFrame *frame) {
+// 解析 YUV4MPEG2 之后的文件头参数，W、H必须有，C缺省为420
+static int parseY4MHeader(InputStream *in) {
+    char line[1024], *tok, *save;
 
-    FILE *file = fopen(image_yuv, "rb");
-    if (file == NULL) {
-        printf("Fail to open input YUV!\n");
+    if (readLine(in, line, sizeof(line)) < 0) {
+        fprintf(stderr, "Invalid Y4M header!\n");
+        return -1;
+    }
+    in->y4m = 1;
+    in->format = AV_PIX_FMT_YUV420P;
+    strcpy(in->rate, "25:1");
+    strcpy(in->aspect, "0:0");
+    for (tok = strtok_r(line, " ", &save); tok; tok = strtok_r(NULL, " ", &save)) {
+        switch (tok[0]) {
+        case 'W': in->width  = atoi(tok + 1); break;
+        case 'H': in->height = atoi(tok + 1); break;
+        case 'F': snprintf(in->rate,   sizeof(in->rate),   "%s", tok + 1); break;
+        case 'A': snprintf(in->aspect, sizeof(in->aspect), "%s", tok + 1); break;
+        case 'C': {
+            int i, n = sizeof(y4mColorTags) / sizeof(y4mColorTags[0]);
+            for (i = 0; i < n; i++)
+                if (!strcmp(tok + 1, y4mColorTags[i].tag))
+                    break;
+            if (i == n) {
+                fprintf(stderr, "Unsupported Y4M colorspace '%s'\n", tok + 1);
+                return -1;
+            }
+            in->format = y4mColorTags[i].format;
+            break;
+        }
+        default:    // I（场序）和X（扩展）等参数不影响缩放
+            break;
+        }
+    }
+    if (in->width <= 0 || in->height <= 0) {
+        fprintf(stderr, "Y4M header has no valid W/H!\n");
         return -1;
     }
+    return 0;
+}
 
-    fseek(file, 0, SEEK_END);
-    uint32_t length = ftell(file);
-    fseek(file, 0, SEEK_SET);
+static int openInput(InputStream *in, const char *image_yuv) {
+
+    memset(in, 0, sizeof(*in));
+    if (!strcmp(image_yuv, "-")) {
+        in->file = stdin;
+        in->npeek = fread(in->peek, 1, Y4M_MAGIC_LEN, stdin);
+        if (in->npeek == Y4M_MAGIC_LEN && !memcmp(in->peek, Y4M_MAGIC, Y4M_MAGIC_LEN)) {
+            in->npeek = 0;
+            return parseY4MHeader(in);
+        }
+        return 0;
+    }
 
-    uint8_t *bs_data = malloc(length);
-    if (bs_data == NULL) {
-        printf("Memory allocation failed!\n");
-        fclose(file);
+    int fd = open(image_yuv, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Fail to open input YUV!\n");
         return -1;
     }
 
-    fread(bs_data, sizeof(uint8_t), length, file);
-    frame->data[0] = bs_data;
-    frame->data[1] = bs_data + frame->Ysize;
-    frame->data[2] = bs_data + frame->Ysize + frame->UVsize;
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size == 0) {
+        fprintf(stderr, "Input YUV is empty!\n");
+        close(fd);
+        return -1;
+    }
 
-    fclose(file);
+    in->map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // 映射建立后文件描述符不再需要
+    if (in->map == MAP_FAILED) {
+        in->map = NULL;
+        fprintf(stderr, "Fail to map input YUV!\n");
+        return -1;
+    }
+    // 缩放按行从上往下读，顺序预读让后面的页在缩放前面的行时就被读入
+    madvise(in->map, st.st_size, MADV_SEQUENTIAL);
+    in->maplen = st.st_size;
 
+    if (in->maplen >= Y4M_MAGIC_LEN && !memcmp(in->map, Y4M_MAGIC, Y4M_MAGIC_LEN)) {
+        in->pos = Y4M_MAGIC_LEN;
+        return parseY4MHeader(in);
+    }
     return 0;
 }
 
-static int writeAVFrame(const char *output_filename, AVFrame *frame) {
+static void closeInput(InputStream *in) {
+    if (in->map)
+        munmap(in->map, in->maplen);
+}
 
-    // 打开文件准备写入数据
-    FILE *file = fopen(output_filename, "wb");
-    if (file == NULL) {
-        printf("Fail to open output file! \n");
-        return -1;
+// 取下一帧，data[]指向映射区或帧缓冲区*buf，不再拷贝一份；*buf在第一次从标准输入读时分配
+// 返回0表示取到一帧，1表示输入结束，末尾不足一帧的数据被丢弃，出错返回负数
+static int readAVFrame(InputStream *in, AVFrame *frame, uint8_t **buf) {
+
+    size_t size = frameSize(frame);
+
+    if (in->y4m) {  // 每帧数据前是一行以FRAME开头的帧头
+        char line[256];
+        if (readLine(in, line, sizeof(line)) < 0)
+            return 1;
+        if (strncmp(line, "FRAME", 5)) {
+            fprintf(stderr, "Invalid Y4M frame header!\n");
+            return -1;
+        }
     }
 
-    // 写入 Y 数据
-    fwrite(frame->data[0], sizeof(uint8_t), frame->Ysize, file);
+    if (in->file) {
+        if (!*buf && !(*buf = malloc(size)))
+            return -12;
+        memcpy(*buf, in->peek, in->npeek);
+        size_t n = in->npeek + fread(*buf + in->npeek, 1, size - in->npeek, in->file);
+        in->npeek = 0;
+        if (n < size) {
+            if (n)
+                fprintf(stderr, "Ignoring %zu trailing bytes of an incomplete frame\n", n);
+            return 1;
+        }
+        setFramePlanes(frame, *buf);
+        return 0;
+    }
 
-    fwrite(frame->data[1], sizeof(uint8_t), frame->UVsize, file);
-    if(frame->UVsize != frame->Ysize / 2)  // 说明不是NV12 或者 NV21，UV分开存储
-        fwrite(frame->data[2], sizeof(uint8_t), frame->UVsize, file);
+    if (in->maplen - in->pos < size) {
+        if (in->maplen > in->pos)
+            fprintf(stderr, "Ignoring %zu trailing bytes of an incomplete frame\n", in->maplen - in->pos);
+        return 1;
+    }
+    setFramePlanes(frame, in->map + in->pos);
+    in->pos += size;
 
-    fclose(file);
     return 0;
 }
 
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+// 把iov中的数据全部写出，writev只写了一部分时从断开的地方继续
+static int writeAll(int fd, struct iovec *iov, int cnt) {
+    while (cnt > 0) {
+        ssize_t n = writev(fd, iov, cnt);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        while (cnt > 0 && (size_t)n >= iov->iov_len) {
+            n -= iov->iov_len;
+            iov++;
+            cnt--;
+        }
+        if (cnt > 0) {
+            iov->iov_base = (uint8_t *)iov->iov_base + n;
+            iov->iov_len -= n;
+        }
+    }
+    return 0;
+}
+
+// 写Y4M文件头，帧率和宽高比沿用Y4M输入中的值
+static int writeY4MHeader(int fd, const AVFrame *frame, const InputStream *in) {
+    int i, n = sizeof(y4mColorTags) / sizeof(y4mColorTags[0]);
+    char header[256];
+    struct iovec iov;
+
+    for (i = 0; i < n; i++)
+        if (y4mColorTags[i].format == frame->format)
+            break;
+    if (i == n) {
+        fprintf(stderr, "Output format %s cannot be stored in Y4M\n",
+                av_pix_fmt_desc_get(frame->format)->name);
+        return -1;
+    }
+    iov.iov_base = header;
+    iov.iov_len = snprintf(header, sizeof(header), "%s W%d H%d F%s Ip A%s C%s\n", Y4M_MAGIC,
+                           frame->width, frame->height, in->y4m ? in->rate : "25:1",
+                           in->y4m ? in->aspect : "0:0", y4mColorTags[i].tag);
+    return writeAll(fd, &iov, 1);
+}
+
+// 一次writev写出一帧（以及可选的帧头），不经过stdio缓冲区
+// 跨距等于行宽的平面作为一段整体写出，否则逐行写出，跳过行尾的填充
+static int writeAVFrame(int fd, const AVFrame *frame, const char *header) {
+    struct iovec iov[IOV_MAX];
+    int rowBytes[4], rows[4], cnt = 0;
+
+    av_image_plane_sizes(rowBytes, rows, frame->format, frame->width, frame->height);
+    if (header) {
+        iov[cnt].iov_base = (char *)header;
+        iov[cnt++].iov_len = strlen(header);
+    }
+    for (int i = 0; i < 4; i++) {
+        if (!rowBytes[i])
+            continue;
+        int contiguous = frame->linesize[i] == rowBytes[i];
+        int segs = contiguous ? 1 : rows[i];
+        for (int y = 0; y < segs; y++) {
+            if (cnt == IOV_MAX) {   // 超过一次writev的上限时分批写
+                if (writeAll(fd, iov, cnt) < 0)
+                    return -1;
+                cnt = 0;
+            }
+            iov[cnt].iov_base = frame->data[i] + (size_t)y * frame->linesize[i];
+            iov[cnt++].iov_len = contiguous ? (size_t)rowBytes[i] * rows[i] : rowBytes[i];
+        }
+    }
+    return writeAll(fd, iov, cnt);
+}
 
 static int initAVFrame(AVFrame *frame, unsigned int width, unsigned int height, enum AVPixelFormat pixelFormat){
     // 分配AVFrame所需的内存
 
     if (!frame) {
         // 处理内存分配失败的情况
-        printf("failed for alloc !\n");
+        fprintf(stderr, "failed for alloc !\n");
         return -1;
     }
     //不考虑对齐
+    int rowBytes[4], rows[4];
 
-    frame->linesize[0] = width;
-    frame->linesize[3] = 0;
-    if (pixelFormat == AV_PIX_FMT_NV21 || pixelFormat == AV_PIX_FMT_NV12 ) {
-
-        frame->linesize[1] = width;
-        frame->linesize[2] = 0;
-        frame->subsample = 1;
-        frame->Ysize = frame->linesize[0] * height;
-        frame->UVsize = frame->linesize[1] * height/2;
-    } else if( pixelFormat == AV_PIX_FMT_YUV420P ){
-
-        frame->linesize[1] = width / 2 ;
-        frame->linesize[2] = width / 2;
-        frame->subsample = 1;// 用来做位移
-        frame->Ysize = frame->linesize[0] * height;
-        frame->UVsize = frame->linesize[1] * height/2;
-
-    }else if (AV_PIX_FMT_YUV444P) {
-
-        frame->linesize[1] = width;
-        frame->linesize[2] = width;
-        frame->subsample = 0;
-        frame->Ysize = frame->UVsize = frame->linesize[0] * height;
-    }
+    av_image_plane_sizes(rowBytes, rows, pixelFormat, width, height);
+    for (int i = 0; i < 4; i++)
+        frame->linesize[i] = rowBytes[i];
+    frame->Ysize = frame->linesize[0] * rows[0];
+    frame->UVsize = frame->linesize[1] * rows[1];
     // 设置AVFrame的宽度、高度和像素格式
     frame->width = width;
     frame->height = height;
@@ -102,61 +334,572 @@ static int initAVFrame(AVFrame *frame, unsigned int width, unsigned int height,
     return 0;
 }
 
-enum AVPixelFormat getPixelFormatFromString(const char *format) {
-    if (strcmp(format, "YUV420P") == 0) {
-        return AV_PIX_FMT_YUV420P;
-    } else if (strcmp(format, "YUV444P") == 0) {
-        return AV_PIX_FMT_YUV444P;
-    } else if (strcmp(format, "NV12") == 0) {
-        return AV_PIX_FMT_NV12;
-    } else if (strcmp(format, "NV21") == 0) {
-        return AV_PIX_FMT_NV21;
-    // 其他枚举值的映射
+#define MAX_SCALE_THREADS 16
+
+enum { SLOT_FREE, SLOT_READ, SLOT_SCALED };
+
+// 流水线中的一帧：输入、输出和当前状态，帧号n使用第 n % nb_slots 个
+typedef struct PipelineSlot {
+    AVFrame in;
+    AVFrame out;
+    uint8_t *inbuf;     ///< 标准输入的帧缓冲区
+    int frame;          ///< 当前存放的帧号
+    int state;
+} PipelineSlot;
+
+/*
+ 读、缩放、写三级流水线：读线程、nb_threads个缩放线程和写线程（调用线程）
+ 通过一组预先分配好的帧交接，第N帧缩放的同时读N+1帧、写N-1帧
+ 所有状态由一个互斥量保护，状态变化时广播唤醒所有等待的线程
+*/
+typedef struct Pipeline {
+    InputStream *in;
+    int out;                    ///< 输出文件描述符
+    int y4mOut;
+    SwsBatchContext batch;      ///< 每个缩放线程一个上下文，共享滤波器系数
+    PipelineSlot *slots;
+    int nb_slots;
+    int nb_frames;              ///< 输入的总帧数，读到输入结束之前为INT_MAX
+    int next_scale;             ///< 下一个等待缩放的帧号
+    int error;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} Pipeline;
+
+typedef struct ScaleThread {
+    Pipeline *p;
+    SwsContext *c;
+} ScaleThread;
+
+/*
+ 按格式为一帧分配缓冲区，各平面大小由格式决定，所有平面放在一整块内存中
+ 每个平面的起始地址按64字节对齐，行尾不填充（跨距等于行宽），这样每个平面都是连续的一段，
+ writeAVFrame() 一个平面只需要一个iovec；行宽是64的倍数时每行的起始地址自然也是对齐的，
+ 否则只有平面起点对齐，缩放内核逐样本访问，不依赖行对齐
+ 缩放会写满所有平面，所以不清零；zero非0时清零（只缩放亮度时色度不会被写入）
+*/
+static int allocFrameBuffers(AVFrame *frame, int zero) {
+    int rowBytes[4], rows[4], linesize[4];
+    int size = av_image_alloc(frame->data, linesize, frame->width, frame->height,
+                              frame->format, 1);
+
+    if (size < 0)
+        return size;
+    for (int i = 0; i < 4; i++)
+        frame->linesize[i] = linesize[i];
+    if (zero)
+        memset(frame->data[0], 0, size);
+    av_image_plane_sizes(rowBytes, rows, frame->format, frame->width, frame->height);
+    frame->Ysize = frame->linesize[0] * rows[0];
+    frame->UVsize = frame->linesize[1] * rows[1];
+    return 0;
+}
+
+static void freeFrameBuffers(AVFrame *frame) {
+    av_free(frame->data[0]);
+    memset(frame->data, 0, sizeof(frame->data));
+}
+
+// 等待帧号n的帧进入state状态，输入结束或出错时返回非0
+static int waitSlot(Pipeline *p, int n, int state) {
+    PipelineSlot *slot = &p->slots[n % p->nb_slots];
+
+    while (!p->error && n < p->nb_frames && !(slot->frame == n && slot->state == state))
+        pthread_cond_wait(&p->cond, &p->lock);
+    return p->error || n >= p->nb_frames;
+}
+
+static void setSlotState(Pipeline *p, PipelineSlot *slot, int state) {
+    pthread_mutex_lock(&p->lock);
+    slot->state = state;
+    pthread_cond_broadcast(&p->cond);
+    pthread_mutex_unlock(&p->lock);
+}
+
+static void *readThread(void *arg) {
+    Pipeline *p = arg;
+
+    for (int n = 0; ; n++) {
+        PipelineSlot *slot = &p->slots[n % p->nb_slots];
+
+        pthread_mutex_lock(&p->lock);
+        while (!p->error && slot->state != SLOT_FREE)
+            pthread_cond_wait(&p->cond, &p->lock);
+        pthread_mutex_unlock(&p->lock);
+        if (p->error)
+            break;
+
+        int ret = readAVFrame(p->in, &slot->in, &slot->inbuf);
+        if (ret == -12)
+            fprintf(stderr, "Memory allocation failed!\n");
+        if (ret == 0 && p->in->map) {
+            // 映射的输入在这里把整帧的页读进来，缩放线程不再因为缺页等待磁盘
+            volatile uint8_t sum = 0;
+            size_t size = frameSize(&slot->in);
+            for (size_t i = 0; i < size; i += 4096)
+                sum += slot->in.data[0][i];
+        }
+
+        pthread_mutex_lock(&p->lock);
+        if (ret != 0) {
+            p->nb_frames = n;
+            p->error |= ret < 0;
+        } else {
+            slot->frame = n;
+            slot->state = SLOT_READ;
+        }
+        pthread_cond_broadcast(&p->cond);
+        pthread_mutex_unlock(&p->lock);
+        if (ret != 0)
+            break;
+    }
+    return NULL;
+}
+
+static void *scaleThread(void *arg) {
+    ScaleThread *t = arg;
+    Pipeline *p = t->p;
+
+    for (;;) {
+        pthread_mutex_lock(&p->lock);
+        int n = p->next_scale++;
+        int done = waitSlot(p, n, SLOT_READ);
+        pthread_mutex_unlock(&p->lock);
+        if (done)
+            break;
+
+        PipelineSlot *slot = &p->slots[n % p->nb_slots];
+        int srcStride[4], dstStride[4];
+        // AVFrame的跨距是无符号数，sws_scale()用有符号的跨距
+        for (int i = 0; i < 4; i++) {
+            srcStride[i] = slot->in.linesize[i];
+            dstStride[i] = slot->out.linesize[i];
+        }
+        if (sws_scale(t->c, (const uint8_t **)slot->in.data, srcStride, 0, t->c->srcH,
+                      slot->out.data, dstStride) < 0) { //真正做缩放的地方
+            // 缩放失败的帧不能当作有效帧写出，通知其他线程一起退出
+            pthread_mutex_lock(&p->lock);
+            p->error = 1;
+            pthread_cond_broadcast(&p->cond);
+            pthread_mutex_unlock(&p->lock);
+            break;
+        }
+        setSlotState(p, slot, SLOT_SCALED);
+    }
+    return NULL;
+}
+
+// 按帧号顺序写出缩放好的帧，在调用线程中运行
+static void writeFrames(Pipeline *p) {
+    for (int n = 0; ; n++) {
+        PipelineSlot *slot = &p->slots[n % p->nb_slots];
+
+        pthread_mutex_lock(&p->lock);
+        int done = waitSlot(p, n, SLOT_SCALED);
+        pthread_mutex_unlock(&p->lock);
+        if (done)
+            break;
+
+        if (writeAVFrame(p->out, &slot->out, p->y4mOut ? "FRAME\n" : NULL) != 0) {
+            fprintf(stderr, "Data dump failed! \n");
+            pthread_mutex_lock(&p->lock);
+            p->error = 1;
+            pthread_cond_broadcast(&p->cond);
+            pthread_mutex_unlock(&p->lock);
+            break;
+        }
+        setSlotState(p, slot, SLOT_FREE);
+    }
+}
+
+// 用流水线处理输入中的所有帧，返回处理的帧数，出错返回负数
+// inframe、outframe只提供帧的格式和跨距，每个槽位分配自己的缓冲区
+static int runPipeline(InputStream *in, int out, int y4mOut, SwsContext *s,
+                       const AVFrame *inframe, const AVFrame *outframe, int nb_threads) {
+    Pipeline p = { 0 };
+    ScaleThread threads[MAX_SCALE_THREADS];
+    pthread_t reader, scalers[MAX_SCALE_THREADS];
+    int i, nb_scalers = 0, ret = -12;
+
+    p.in = in;
+    p.out = out;
+    p.y4mOut = y4mOut;
+    p.nb_frames = INT_MAX;
+    p.nb_slots = nb_threads + 2;    // 一帧在读，nb_threads帧在缩放，一帧在写
+    pthread_mutex_init(&p.lock, NULL);
+    pthread_cond_init(&p.cond, NULL);
+
+    if (sws_init_batch_context(&p.batch, s, nb_threads) < 0)
+        goto nomem;
+    p.slots = av_mallocz_array(p.nb_slots, sizeof(*p.slots));
+    if (!p.slots)
+        goto nomem;
+    for (i = 0; i < p.nb_slots; i++) {
+        p.slots[i].in = *inframe;
+        p.slots[i].out = *outframe;
+        p.slots[i].frame = -1;
+        if (allocFrameBuffers(&p.slots[i].out, s->lumaOnly) < 0)
+            goto nomem;
+    }
+
+    ret = -1;
+    if (pthread_create(&reader, NULL, readThread, &p)) {
+        fprintf(stderr, "Fail to create reader thread!\n");
+        goto end;
+    }
+    for (i = 0; i < nb_threads; i++) {
+        threads[i].p = &p;
+        threads[i].c = p.batch.workers[i];
+        if (pthread_create(&scalers[i], NULL, scaleThread, &threads[i])) {
+            fprintf(stderr, "Fail to create scaling thread %d\n", i);
+            break;
+        }
+        nb_scalers++;
+    }
+    if (nb_scalers) {
+        writeFrames(&p);
     } else {
-        // 处理无效格式的情况
-        return AV_PIX_FMT_YUV420P; // 或者其他默认值
+        pthread_mutex_lock(&p.lock);
+        p.error = 1;
+        pthread_cond_broadcast(&p.cond);
+        pthread_mutex_unlock(&p.lock);
+    }
+
+    pthread_join(reader, NULL);
+    for (i = 0; i < nb_scalers; i++)
+        pthread_join(scalers[i], NULL);
+    ret = p.error ? -1 : p.nb_frames;
+    goto end;
+
+nomem:
+    fprintf(stderr, "Memory allocation failed!\n");
+end:
+    if (p.slots) {
+        for (i = 0; i < p.nb_slots; i++) {
+            freeFrameBuffers(&p.slots[i].out);
+            free(p.slots[i].inbuf);
+        }
+        av_freep(&p.slots);
+    }
+    sws_free_batch_context(&p.batch);
+    pthread_mutex_destroy(&p.lock);
+    pthread_cond_destroy(&p.cond);
+    return ret;
+}
+
+#define BATCH_GROUP 32     ///< 批量模式每组的文件数
+
+// 批量模式的一组文件，输入输出各一个连续的缓冲区，每个文件占其中一帧
+typedef struct BatchGroup {
+    FileIORequest reads[BATCH_GROUP];
+    FileIORequest writes[BATCH_GROUP];
+    uint8_t *inbuf;
+    uint8_t *outbuf;
+    int first;                  ///< 第一个文件在列表中的索引
+    int count;
+    int wfirst;                 ///< 在途的写请求对应的文件，读下一组时first和count已经变了
+    int wcount;
+} BatchGroup;
+
+// 读入文件列表，每行一个输入路径，忽略空行
+static char **readFileList(const char *listname, int *count) {
+    FILE *file = fopen(listname, "r");
+    char line[4096], **list = NULL;
+    int n = 0;
+
+    if (!file) {
+        fprintf(stderr, "Fail to open file list!\n");
+        return NULL;
+    }
+    while (fgets(line, sizeof(line), file)) {
+        line[strcspn(line, "\r\n")] = 0;
+        if (!line[0])
+            continue;
+        char **tmp = realloc(list, (n + 1) * sizeof(*list));
+        if (!tmp)
+            break;
+        list = tmp;
+        if (!(list[n] = strdup(line)))
+            break;
+        n++;
+    }
+    fclose(file);
+    *count = n;
+    return list;
+}
+
+// 打开一组输入文件并一次提交所有读请求
+static int submitReads(FileIOContext *io, BatchGroup *g, char **names, size_t size) {
+    for (int i = 0; i < g->count; i++) {
+        FileIORequest *req = &g->reads[i];
+        req->fd = open(names[g->first + i], O_RDONLY);
+        if (req->fd < 0)
+            fprintf(stderr, "Fail to open %s\n", names[g->first + i]);
+        req->buf = g->inbuf + i * size;
+        req->len = size;
+        req->offset = 0;
+    }
+    return fileio_submit(io, g->reads, g->count, 0);
+}
+
+// 打开一组输出文件并一次提交所有写请求，输出和输入同名，放在输出目录中
+static int submitWrites(FileIOContext *io, BatchGroup *g, char **names, const char *outdir, size_t size) {
+    for (int i = 0; i < g->count; i++) {
+        FileIORequest *req = &g->writes[i];
+        const char *base = strrchr(names[g->first + i], '/');
+        char path[4096];
+
+        req->fd = -1;
+        if (g->reads[i].result == (ssize_t)g->reads[i].len) {   // 输入读取失败的文件不写
+            snprintf(path, sizeof(path), "%s/%s", outdir, base ? base + 1 : names[g->first + i]);
+            req->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (req->fd < 0)
+                fprintf(stderr, "Fail to open %s\n", path);
+        }
+        req->buf = g->outbuf + i * size;
+        req->len = size;
+        req->offset = 0;
+    }
+    g->wfirst = g->first;
+    g->wcount = g->count;
+    return fileio_submit(io, g->writes, g->count, 1);
+}
+
+// 请求完成后关闭文件，返回成功的个数
+static int finishRequests(FileIORequest *reqs, int count, char **names, int first) {
+    int ok = 0;
+
+    for (int i = 0; i < count; i++) {
+        if (reqs[i].fd < 0)
+            continue;
+        close(reqs[i].fd);
+        if (reqs[i].result == (ssize_t)reqs[i].len)
+            ok++;
+        else
+            fprintf(stderr, "Fail to %s %s\n", reqs[i].write ? "write" : "read", names[first + i]);
+    }
+    return ok;
+}
+
+/*
+ 批量模式：列表中的每个输入文件是一帧，缩放后写到输出目录中的同名文件
+ 文件分组处理，读下一组、缩放这一组、写上一组同时进行，读写请求整组提交，
+ 有io_uring时读写在内核中异步完成，单核上也能把I/O等待藏在缩放后面
+ 返回成功写出的文件数，出错返回负数
+*/
+static int runBatch(const char *listname, const char *outdir, SwsContext *s,
+                    const AVFrame *inframe, const AVFrame *outframe, int use_uring) {
+    size_t insize = frameSize(inframe), outsize = frameSize(outframe);
+    BatchGroup groups[2] = { { { { 0 } } } }, *writing = NULL;
+    FileIOContext io;
+    char **names;
+    int i, k, nb_files = 0, nb_groups, done = 0, ret = -12;
+
+    if (!(names = readFileList(listname, &nb_files)))
+        return -1;
+    nb_groups = (nb_files + BATCH_GROUP - 1) / BATCH_GROUP;
+
+    // 同时在途的是下一组的读和上一组的写
+    fileio_init(&io, 2 * BATCH_GROUP, use_uring);
+    fprintf(stderr, "Batch of %d files using %s\n", nb_files, io.use_uring ? "io_uring" : "pread/pwrite");
+    for (i = 0; i < 2; i++) {
+        groups[i].inbuf = av_mallocz_array(BATCH_GROUP, insize);
+        groups[i].outbuf = av_mallocz_array(BATCH_GROUP, outsize);
+        if (!groups[i].inbuf || !groups[i].outbuf)
+            goto end;
+    }
+
+    ret = -1;
+    if (nb_groups) {
+        groups[0].count = FFMIN(nb_files, BATCH_GROUP);
+        if (submitReads(&io, &groups[0], names, insize) < 0 || fileio_wait(&io) < 0)
+            goto end;
+        finishRequests(groups[0].reads, groups[0].count, names, 0);
+    }
+    for (k = 0; k < nb_groups; k++) {
+        BatchGroup *cur = &groups[k & 1], *next = &groups[(k + 1) & 1];
+
+        // 下一组的输入缓冲区上一轮已经缩放完，输出缓冲区要等上一组写完才会被再次使用
+        if (k + 1 < nb_groups) {
+            next->first = (k + 1) * BATCH_GROUP;
+            next->count = FFMIN(nb_files - next->first, BATCH_GROUP);
+            if (submitReads(&io, next, names, insize) < 0)
+                goto end;
+        }
+
+        for (i = 0; i < cur->count; i++) {
+            AVFrame src = *inframe, dst = *outframe;
+            int srcStride[4], dstStride[4];
+
+            if (cur->reads[i].result != (ssize_t)insize)
+                continue;
+            setFramePlanes(&src, cur->inbuf + i * insize);
+            setFramePlanes(&dst, cur->outbuf + i * outsize);
+            for (int j = 0; j < 4; j++) {
+                srcStride[j] = src.linesize[j];
+                dstStride[j] = dst.linesize[j];
+            }
+            sws_scale(s, (const uint8_t **)src.data, srcStride, 0, s->srcH, dst.data, dstStride);
+        }
+
+        // 等下一组读完、上一组写完，再提交这一组的写
+        if (fileio_wait(&io) < 0)
+            goto end;
+        if (k + 1 < nb_groups)
+            finishRequests(next->reads, next->count, names, next->first);
+        if (writing)
+            done += finishRequests(writing->writes, writing->wcount, names, writing->wfirst);
+        writing = NULL;
+        if (submitWrites(&io, cur, names, outdir, outsize) < 0)
+            goto end;
+        writing = cur;
+    }
+    ret = 0;
+
+end:
+    fileio_wait(&io);
+    if (writing)
+        done += finishRequests(writing->writes, writing->wcount, names, writing->wfirst);
+    if (!ret)
+        ret = done;
+    fileio_uninit(&io);
+    for (i = 0; i < 2; i++) {
+        free(groups[i].inbuf);
+        free(groups[i].outbuf);
     }
+    for (i = 0; i < nb_files; i++)
+        free(names[i]);
+    free(names);
+    return ret;
 }
+
+// 打印描述符链中每个阶段的累计耗时（-timing），需要编译时定义SWS_TIMING
+static void printTiming(SwsContext *s) {
+    SwsStageTiming stages[8];
+    int n = sws_get_timing(s, stages, sizeof(stages) / sizeof(stages[0]));
+
+    if (n == 0) {
+        fprintf(stderr, "Timing is not compiled in, rebuild with: make clean && make OPTFLAGS=-DSWS_TIMING\n");
+        return;
+    }
+#ifdef SWS_TIMING
+    uint64_t total = 0;
+    for (int i = 0; i < n; i++)
+        total += stages[i].cycles;
+    fprintf(stderr, "%-14s %10s %10s %14s %12s %7s\n", "stage", "calls", "rows", SWS_TIMER_UNIT, "per row", "share");
+    for (int i = 0; i < n; i++)
+        fprintf(stderr, "%-14s %10lld %10lld %14llu %12.1f %6.1f%%\n", stages[i].name,
+                (long long)stages[i].calls, (long long)stages[i].rows, (unsigned long long)stages[i].cycles,
+                stages[i].rows ? (double)stages[i].cycles / stages[i].rows : 0.0,
+                total ? 100.0 * stages[i].cycles / total : 0.0);
+#endif
+}
+
 // 输入应该包括：
-// 1 输入YUV路径
+// 1 输入YUV路径，可以包含多帧，"-"表示标准输入
 // 2 指定输入宽
 // 3 指定输入高
-// 4 指定输入YUV格式，输出和输入保持一致
+// 4 指定输入YUV格式，默认输出和输入保持一致
 // 5 指定输出宽
 // 6 指定输出高
+// 7 输出YUV路径，"-"表示标准输出
+// 输入是Y4M时宽高和格式取自文件头，省去2、3、4三项：<输入> <输出宽> <输出高> <输出路径>
+// 输出路径以.y4m结尾，或者Y4M输入写到标准输出时，输出也是Y4M
+// 可选 -crop x:y:w:h 只缩放输入中的一个区域
+// 可选 -outfmt 指定输出格式（YUV或RGB）
+// 可选 -colorspace 601|709 和 -range limited|full 指定YUV和RGB转换时YUV一侧的矩阵和范围
+// 可选 -lumaonly 只缩放亮度，输出文件中的色度保持为0
+// 可选 -threads N 缩放线程数，读和写各在一个线程中和缩放重叠进行
+// 可选 -batch 批量模式，1是输入文件列表（每行一个单帧文件），7是输出目录
+// 可选 -io uring|sync 批量模式的读写方式，默认使用io_uring，不可用时退回pread/pwrite
+// 可选 -timing 结束时打印各阶段（水平、垂直缩放等）的耗时，需要用 OPTFLAGS=-DSWS_TIMING 编译
 int main(int argc, char* argv[])
 {
 
-    if (argc != 8)
+    const char *options = "[-crop x:y:w:h] [-outfmt pixformat] [-colorspace 601|709] [-range limited|full] [-lumaonly] [-threads N] [-batch] [-io uring|sync] [-timing]";
+    InputStream in;
+    int batch = 0;
+    for (int i = 1; i < argc; i++)
+        batch |= !strcmp(argv[i], "-batch");
+    // 批量模式下1是文件列表；其他情况先打开输入，Y4M输入的命令行参数少三项
+    memset(&in, 0, sizeof(in));
+    if (argc < 2 || (!batch && openInput(&in, argv[1]) != 0) || argc < (in.y4m ? 5 : 8))
     {
-        fprintf(stderr, "Usage:%s <YUV IN PATH> <srcW> <srcH> <pixformat> <dstW> <dstH> <YUV OUT PATH>\n", argv[0]);
+        fprintf(stderr, "Usage:%s <YUV IN PATH> <srcW> <srcH> <pixformat> <dstW> <dstH> <YUV OUT PATH> %s\n", argv[0], options);
+        fprintf(stderr, "      %s <Y4M IN PATH> <dstW> <dstH> <OUT PATH> %s\n", argv[0], options);
         return -1;
     }
     int ret;
-    const char *infilename  = argv[1];
-    const char *outfilename = argv[7];
+    int cropX = 0, cropY = 0, cropW = 0, cropH = 0;
+    const char *outfmtname = NULL;
+    int colorspace = SWS_CS_DEFAULT, fullRange = 0;
+    int lumaOnly = 0;
+    int nb_threads = 1;
+    int use_uring = 1;
+    int timing = 0;
+    // 可选参数
+    for (int i = in.y4m ? 5 : 8; i < argc; i++) {
+        if (!strcmp(argv[i], "-crop") && i + 1 < argc) {
+            if (sscanf(argv[++i], "%d:%d:%d:%d", &cropX, &cropY, &cropW, &cropH) != 4) {
+                fprintf(stderr, "Invalid crop '%s', expected x:y:w:h\n", argv[i]);
+                return -1;
+            }
+        } else if (!strcmp(argv[i], "-outfmt") && i + 1 < argc) {
+            outfmtname = argv[++i];
+        } else if (!strcmp(argv[i], "-colorspace") && i + 1 < argc) {
+            colorspace = atoi(argv[++i]) == 709 ? SWS_CS_ITU709 : SWS_CS_ITU601;
+        } else if (!strcmp(argv[i], "-range") && i + 1 < argc) {
+            fullRange = !strcmp(argv[++i], "full");
+        } else if (!strcmp(argv[i], "-lumaonly")) {
+            lumaOnly = 1;
+        } else if (!strcmp(argv[i], "-threads") && i + 1 < argc) {
+            nb_threads = atoi(argv[++i]);
+            nb_threads = FFMIN(FFMAX(nb_threads, 1), MAX_SCALE_THREADS);
+        } else if (!strcmp(argv[i], "-batch")) {
+            // 已经在前面处理
+        } else if (!strcmp(argv[i], "-io") && i + 1 < argc) {
+            use_uring = strcmp(argv[++i], "sync") != 0;
+        } else if (!strcmp(argv[i], "-timing")) {
+            timing = 1;
+        } else {
+            fprintf(stderr, "Unknown option '%s'\n", argv[i]);
+            return -1;
+        }
+    }
+    const char *outfilename;
     unsigned int srcW, srcH, dstW, dstH;
     enum AVPixelFormat infmt, outfmt;
-    srcW = atoi(argv[2]);
-    srcH = atoi(argv[3]);
-    infmt = outfmt = getPixelFormatFromString(argv[4]);
-    dstW = atoi(argv[5]);
-    dstH = atoi(argv[6]);
+    if (in.y4m) {
+        srcW = in.width;
+        srcH = in.height;
+        infmt = in.format;
+        dstW = atoi(argv[2]);
+        dstH = atoi(argv[3]);
+        outfilename = argv[4];
+    } else {
+        srcW = atoi(argv[2]);
+        srcH = atoi(argv[3]);
+        infmt = getPixelFormatFromString(argv[4]);
+        dstW = atoi(argv[5]);
+        dstH = atoi(argv[6]);
+        outfilename = argv[7];
+    }
+    outfmt = infmt;
+    if (outfmtname)     // 输出格式可以和输入不同，缩放的同时完成格式转换
+        outfmt = getPixelFormatFromString(outfmtname);
+    if (infmt == AV_PIX_FMT_NONE || outfmt == AV_PIX_FMT_NONE) {
+        fprintf(stderr, "Unknown pixel format '%s'\n", infmt == AV_PIX_FMT_NONE ? argv[4] : outfmtname);
+        return -1;
+    }
+    size_t outlen = strlen(outfilename);
+    int y4mOut = (outlen > 4 && !strcmp(outfilename + outlen - 4, ".y4m")) ||
+                 (in.y4m && !strcmp(outfilename, "-"));
     AVFrame *inframe, *outframe;
     inframe = av_mallocz(sizeof(AVFrame));
     initAVFrame(inframe, srcW, srcH, infmt);
     outframe = av_mallocz(sizeof(AVFrame));
 
-    initAVFrame(outframe, dstW, dstH, infmt);
-
-    outframe->data[0] = av_mallocz(outframe->Ysize);
-    outframe->data[1] = av_mallocz(outframe->Ysize);
-    outframe->data[2] = av_mallocz(outframe->Ysize);
-
-    if(ret = readAVFrame(infilename, inframe) !=0 ){
-        printf("Read Data Failed!\n");
-        return -1;
-    }
+    initAVFrame(outframe, dstW, dstH, outfmt);
 
     struct SwsContext *s = av_mallocz(sizeof(SwsContext));
 
@@ -170,21 +913,57 @@ int main(int argc, char* argv[])
     s->dstH = dstH;
     s->dstFormat = outfmt;
     s->flags = 2;
-    s->chrDstHSubSample = s->chrDstVSubSample = s->chrSrcHSubSample = s->chrSrcVSubSample = inframe->subsample;
+    // 只缩放感兴趣区域，输入帧保持完整，不拷贝
+    s->cropX = cropX;
+    s->cropY = cropY;
+    s->cropW = cropW;
+    s->cropH = cropH;
+    s->colorspace = colorspace;
+    s->srcRange = s->dstRange = fullRange;
+    s->lumaOnly = lumaOnly;
 
     if ((ret = sws_init_context(s)) < 0) // 初始化，这里初始化了filter
         return ret;
 
-    int srcSliceY_internal = 0;
-    s->swscale(s, inframe->data, inframe->linesize, srcSliceY_internal, srcH, outframe->data, outframe->linesize); //真正做缩放的地方
+    if (batch) {
+        int files = runBatch(argv[1], outfilename, s, inframe, outframe, use_uring);
+        if (files < 0)
+            return -1;
+        fprintf(stderr, "Data dump success! %d files\n", files);
+        if (timing)
+            printTiming(s);
+        free(inframe);
+        free(outframe);
+        return 0;
+    }
 
-    if (ret = writeAVFrame(outfilename,outframe) != 0){
-        printf("Data dump failed! \n");
+    // 输出为"-"时写到标准输出，便于接在管道中
+    int out = strcmp(outfilename, "-") ? open(outfilename, O_WRONLY | O_CREAT | O_TRUNC, 0644) : STDOUT_FILENO;
+    if (out < 0) {
+        fprintf(stderr, "Fail to open output file! \n");
+        return -1;
+    }
+    if (y4mOut && writeY4MHeader(out, outframe, &in) != 0)
+        return -1;
+
+    // 所有帧共用同一个上下文（每个缩放线程一份切片），输出缓冲区在流水线中循环使用
+    int frames = runPipeline(&in, out, y4mOut, s, inframe, outframe, nb_threads);
+    if (frames < 0)     // 出错的阶段已经打印了原因
+        return -1;
+    if (frames == 0) {
+        fprintf(stderr, "Input YUV is shorter than one frame!\n");
+        return -1;
+    }
+    if (out != STDOUT_FILENO && close(out) != 0) {
+        fprintf(stderr, "Data dump failed! \n");
         return -1;
-    }else{
-        printf("Data dump success! \n");
     }
+    // 状态信息写到标准错误，不混入标准输出上的图像数据
+    fprintf(stderr, "Data dump success! %d frames\n", frames);
+    if (timing)
+        printTiming(s);
 
+    closeInput(&in);
     free(inframe);
     free(outframe);
     inframe = NULL;
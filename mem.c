@@ -36,6 +36,25 @@
 #include "swscale_internal.h"
 
 
+#define ALIGN 64
+
+// 按64字节对齐分配，内容不初始化，可以用av_free或av_freep释放
+void *av_malloc(size_t size)
+{
+    void *ptr = NULL;
+
+    if (size > INT_MAX)
+        return NULL;
+    if (posix_memalign(&ptr, ALIGN, size ? size : 1))
+        ptr = NULL;
+    return ptr;
+}
+
+void av_free(void *ptr)
+{
+    free(ptr);
+}
+
 void *av_mallocz_array(size_t nmemb, size_t size)
 {
     if (!size || nmemb >= INT_MAX / size)
@@ -54,7 +73,7 @@ void av_freep(void *arg)
 // 多了一个把内存中的数据全部置0的过程
 void *av_mallocz(size_t size)
 {
-    void *ptr = malloc(size);
+    void *ptr = av_malloc(size);
     if (ptr)
         memset(ptr, 0, size);
     return ptr;
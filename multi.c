@@ -0,0 +1,182 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "swscale_internal.h"
+
+/*
+ NV输入在进入各个输出上下文前统一解交错，输出上下文看到的是等价的平面格式
+*/
+static enum AVPixelFormat planar_equivalent(enum AVPixelFormat fmt)
+{
+    if (fmt == AV_PIX_FMT_NV12 || fmt == AV_PIX_FMT_NV21)
+        return AV_PIX_FMT_YUV420P;
+    if (fmt == AV_PIX_FMT_NV16)
+        return AV_PIX_FMT_YUV422P;
+    return fmt;
+}
+
+int sws_init_multi_context(SwsMultiContext *m)
+{
+    SwsContext *first;
+    SwsContext tmp = { 0 };
+    const AVPixFmtDescriptor *desc;
+    int i, ret;
+
+    if (m->nb_outputs <= 0 || !m->outputs)
+        return -22;
+
+    first = m->outputs[0];
+    desc = av_pix_fmt_desc_get(first->srcFormat);
+    m->srcW = first->srcW;
+    m->srcH = first->srcH;
+    m->srcFormat = first->srcFormat;
+    m->chrSrcW = AV_CEIL_RSHIFT(first->srcW, desc->log2_chroma_w);
+    m->chrSrcVSubSample = desc->log2_chroma_h;
+
+    // 打包输入的各分量在同一平面中，分块时无法按平面偏移；裁剪区域由swscale()在整帧上计算，分块送入时会错位
+    if (isPacked(m->srcFormat)) {
+        fprintf(stderr, "sws_init_multi_context: packed source %s is not supported\n", desc->name);
+        return -22;
+    }
+    for (i = 0; i < m->nb_outputs; i++) {
+        SwsContext *c = m->outputs[i];
+
+        if (c->srcW != m->srcW || c->srcH != m->srcH || c->srcFormat != m->srcFormat) {
+            fprintf(stderr, "sws_init_multi_context: output %d has a different source\n", i);
+            return -22;
+        }
+        if (c->cropW || c->cropH) {
+            fprintf(stderr, "sws_init_multi_context: output %d sets a crop, which is not supported\n", i);
+            return -22;
+        }
+    }
+
+    // 色度解交错只做一次，P010没有对应的平面格式，仍由各输出自己解交错
+    tmp.srcFormat = m->srcFormat;
+    if (planar_equivalent(m->srcFormat) != m->srcFormat)
+        ff_sws_init_input_funcs(&tmp);
+    m->chrToYV12 = tmp.chrToYV12;
+    if (m->chrToYV12) {
+        int chrLines = SWS_MULTI_SLICE_H >> m->chrSrcVSubSample;
+
+        for (i = 0; i < 2; i++) {
+            m->chrBuf[i] = malloc(m->chrSrcW * chrLines);
+            if (!m->chrBuf[i])
+                return -12;
+        }
+    }
+
+    m->scalers = av_mallocz_array(m->nb_outputs, sizeof(SwsContext *));
+    if (!m->scalers)
+        return -12;
+    for (i = 0; i < m->nb_outputs; i++) {
+        SwsContext *c = m->outputs[i];
+
+        // 需要按平面格式接收色度时复制一份参数，调用者的上下文保持原样
+        if (planar_equivalent(c->srcFormat) != c->srcFormat) {
+            c = malloc(sizeof(*c));
+            if (!c)
+                return -12;
+            *c = *m->outputs[i];
+            c->srcFormat = planar_equivalent(c->srcFormat);
+        }
+        m->scalers[i] = c;
+        if ((ret = sws_init_context(c)) < 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+/*
+ 源图像只检查一次，需要的平面是各路输出用到的平面的并集
+ NV输入的色度交错存放在src[1]中，解交错后才是各路输出看到的平面1和2
+*/
+static int check_source(const SwsMultiContext *m, const uint8_t *const src[], const int srcStride[])
+{
+    int planes = 0, srcPlanes, dstPlanes;
+    int i;
+
+    for (i = 0; i < m->nb_outputs; i++) {
+        ff_sws_used_planes(m->scalers[i], &srcPlanes, &dstPlanes);
+        planes |= srcPlanes;
+    }
+    if (m->chrToYV12 && (planes & 6))
+        planes = (planes & ~6) | 2;
+    for (i = 0; i < 4; i++) {
+        if ((planes >> i & 1) && (!src[i] || !srcStride[i])) {
+            fprintf(stderr, "sws_scale_multi: source plane %d is missing\n", i);
+            return -22;
+        }
+    }
+    return 0;
+}
+
+int sws_scale_multi(SwsMultiContext *m, const uint8_t *const src[], const int srcStride[],
+                    uint8_t **const dst[], int *const dstStride[])
+{
+    int y, i, ret;
+
+    // 参数错误时在写入任何输出之前返回
+    if ((ret = check_source(m, src, srcStride)) < 0)
+        return ret;
+    for (i = 0; i < m->nb_outputs; i++) {
+        if ((ret = ff_sws_check_planes(m->scalers[i], NULL, NULL, dst[i], dstStride[i])) < 0)
+            return ret;
+    }
+
+    for (y = 0; y < m->srcH; y += SWS_MULTI_SLICE_H) {
+        int sliceH = FFMIN(SWS_MULTI_SLICE_H, m->srcH - y);
+        int chrY = y >> m->chrSrcVSubSample;
+        int chrH = AV_CEIL_RSHIFT(sliceH, m->chrSrcVSubSample);
+        const uint8_t *slice[4];
+        int stride[4];
+
+        slice[0] = src[0] + y * srcStride[0];
+        stride[0] = srcStride[0];
+        slice[3] = src[3] ? src[3] + y * srcStride[3] : NULL;
+        stride[3] = src[3] ? srcStride[3] : 0;
+
+        // 所有输出都只缩放亮度时可以不给色度平面
+        if (m->chrToYV12 && src[1]) {
+            for (i = 0; i < chrH; i++)
+                m->chrToYV12(m->chrBuf[0] + i * m->chrSrcW, m->chrBuf[1] + i * m->chrSrcW,
+                             src[1] + (chrY + i) * srcStride[1], m->chrSrcW, NULL);
+            slice[1] = m->chrBuf[0];
+            slice[2] = m->chrBuf[1];
+            stride[1] = stride[2] = m->chrSrcW;
+        } else {
+            // 灰度输入没有色度平面，P010的UV在同一平面中，不存在的平面保持为NULL
+            slice[1] = src[1] ? src[1] + chrY * srcStride[1] : NULL;
+            slice[2] = src[2] ? src[2] + chrY * srcStride[2] : NULL;
+            stride[1] = src[1] ? srcStride[1] : 0;
+            stride[2] = src[2] ? srcStride[2] : 0;
+        }
+
+        // 同一块源数据依次送给所有输出，趁它还在缓存里
+        for (i = 0; i < m->nb_outputs; i++) {
+            if ((ret = sws_scale(m->scalers[i], slice, stride, y, sliceH, dst[i], dstStride[i])) < 0)
+                return ret;
+        }
+    }
+
+    return 0;
+}
+
+void sws_free_multi_context(SwsMultiContext *m)
+{
+    int i;
+
+    if (!m)
+        return;
+
+    for (i = 0; i < m->nb_outputs; i++) {
+        if (m->scalers && m->scalers[i] != m->outputs[i])
+            sws_freeContext(m->scalers[i]);
+        sws_freeContext(m->outputs[i]);
+    }
+    av_freep(&m->scalers);
+    av_freep(&m->chrBuf[0]);
+    av_freep(&m->chrBuf[1]);
+}
@@ -0,0 +1,188 @@
+/*
+ * 测试图案生成器，为回归测试（check.sh）合成确定的输入帧，不依赖外部图片
+ * 图案：
+ *   gradient  各分量方向不同的线性渐变
+ *   checker   黑白棋盘格，亮度格子边长8，色度格子边长4，边缘是最难的情况
+ *   noise     固定种子的伪随机噪声
+ * 样本值覆盖格式位深的全部范围，高位深格式按格式的位数和移位存放（P010的数据在高位）
+ *
+ * 用法：sws_pattern gradient|checker|noise 宽 高 格式 输出文件 [-seed N] [-frames N]
+ * 格式名与 test_resize 相同，如 YUV420P、NV12、P010、RGB24
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "swscale_internal.h"
+#include "imgutils.h"
+
+enum { PATTERN_GRADIENT, PATTERN_CHECKER, PATTERN_NOISE };
+
+static uint32_t seed;
+
+// xorshift32，种子固定时序列在所有平台上相同
+static uint32_t next_random(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+/*
+ 分量comp（0为Y或R，1为U或G，2为V或B，3为A）在(x, y)处的值，范围 0 ~ max
+ x, y 是这个分量自己的采样坐标，w, h 是这个分量的宽高
+*/
+static int sample(int pattern, int comp, int x, int y, int w, int h, int max)
+{
+    switch (pattern) {
+    case PATTERN_GRADIENT:
+        switch (comp) {
+        case 0:  return (int64_t)(x * 2 + y) * max / FFMAX(w * 2 + h - 3, 1);
+        case 1:  return (int64_t)y * max / FFMAX(h - 1, 1);
+        case 2:  return (int64_t)(w - 1 - x + y) * max / FFMAX(w + h - 2, 1);
+        default: return (int64_t)(w - 1 - x) * max / FFMAX(w - 1, 1);
+        }
+    case PATTERN_CHECKER: {
+        int size = comp == 1 || comp == 2 ? 4 : 8;
+        int on = ((x / size) ^ (y / size)) & 1;
+        if (comp == 2)
+            on = !on;
+        return on ? max : 0;
+    }
+    default:
+        return next_random() & max;
+    }
+}
+
+/*
+ 按格式把一帧图案写入buf
+ 平面格式和半平面格式逐平面生成；打包格式按每个字节所属的分量生成
+*/
+static void fill_frame(uint8_t *buf, int pattern, int width, int height, enum AVPixelFormat fmt)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(fmt);
+    int chrW = AV_CEIL_RSHIFT(width, desc->log2_chroma_w);
+    int chrH = AV_CEIL_RSHIFT(height, desc->log2_chroma_h);
+    int max = (1 << desc->bpc) - 1;
+    uint8_t *p = buf;
+
+    if (isPacked(fmt)) {
+        // YUYV: Y U Y V，UYVY: U Y V Y，RGB24: R G B，BGRA: B G R A
+        static const int yuyv[4] = { 0, 1, 0, 2 }, uyvy[4] = { 1, 0, 2, 0 };
+        static const int rgb[3] = { 0, 1, 2 }, bgra[4] = { 2, 1, 0, 3 };
+        const int *order = fmt == AV_PIX_FMT_YUYV422 ? yuyv : fmt == AV_PIX_FMT_UYVY422 ? uyvy :
+                           fmt == AV_PIX_FMT_RGB24 ? rgb : bgra;
+        int step = fmt == AV_PIX_FMT_RGB24 ? 3 : 4;
+        int rowBytes = isPackedYUV(fmt) ? chrW * 4 : width * step;
+
+        for (int y = 0; y < height; y++) {
+            for (int k = 0; k < rowBytes; k++) {
+                int comp = order[k % step];
+                // 打包YUV中一组4个字节是两个像素，亮度的x是组号的两倍加组内第几个亮度
+                int x = isPackedYUV(fmt) ? (comp ? k / 4 : k / 4 * 2 + (k % 4) / 2) : k / step;
+                int w = isPackedYUV(fmt) && comp ? chrW : width;
+                *p++ = sample(pattern, comp, x, y, w, height, 255);
+            }
+        }
+        return;
+    }
+
+    for (int plane = 0; plane < 4; plane++) {
+        int w = plane == 1 || plane == 2 ? chrW : width;
+        int h = plane == 1 || plane == 2 ? chrH : height;
+        int interleaved = plane == 1 && isSemiPlanarYUV(fmt);
+
+        if ((plane == 1 || plane == 2) && isGray(fmt))
+            continue;
+        if (plane == 2 && isSemiPlanarYUV(fmt))
+            continue;
+        if (plane == 3 && !hasAlphaPlane(fmt))
+            continue;
+        for (int y = 0; y < h; y++) {
+            for (int x = 0; x < w * (interleaved ? 2 : 1); x++) {
+                int comp = interleaved ? 1 + ((x & 1) ^ (fmt == AV_PIX_FMT_NV21)) : plane;
+                int cx = interleaved ? x / 2 : x;
+                int v = sample(pattern, comp, cx, y, w, h, plane == 3 ? 255 : max);
+
+                if (isHighBitDepth(fmt) && plane != 3) {
+                    v <<= desc->shift;
+                    *p++ = v & 0xff;        // 小端
+                    *p++ = v >> 8;
+                } else {
+                    *p++ = v;
+                }
+            }
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    const char *usage = "usage: sws_pattern gradient|checker|noise width height format output [-seed N] [-frames N]";
+    int pattern, width, height, frames = 1;
+    enum AVPixelFormat fmt;
+    uint8_t *buf;
+    size_t size;
+    FILE *out;
+
+    if (argc < 6) {
+        printf("%s\n", usage);
+        return -1;
+    }
+    if (!strcmp(argv[1], "gradient")) {
+        pattern = PATTERN_GRADIENT;
+    } else if (!strcmp(argv[1], "checker")) {
+        pattern = PATTERN_CHECKER;
+    } else if (!strcmp(argv[1], "noise")) {
+        pattern = PATTERN_NOISE;
+    } else {
+        printf("Unknown pattern '%s'\n%s\n", argv[1], usage);
+        return -1;
+    }
+    width = atoi(argv[2]);
+    height = atoi(argv[3]);
+    fmt = getPixelFormatFromString(argv[4]);
+    if (fmt == AV_PIX_FMT_NONE) {
+        printf("Unknown pixel format '%s'\n", argv[4]);
+        return -1;
+    }
+    seed = 1;
+    for (int i = 6; i < argc; i++) {
+        if (!strcmp(argv[i], "-seed") && i + 1 < argc) {
+            seed = strtoul(argv[++i], NULL, 0);
+        } else if (!strcmp(argv[i], "-frames") && i + 1 < argc) {
+            frames = atoi(argv[++i]);
+        } else {
+            printf("Unknown option '%s'\n%s\n", argv[i], usage);
+            return -1;
+        }
+    }
+    if (width <= 0 || height <= 0 || frames <= 0) {
+        printf("Invalid size %dx%d or frame count %d\n", width, height, frames);
+        return -1;
+    }
+    if (!seed)      // xorshift的种子不能为0
+        seed = 1;
+
+    size = av_image_frame_size(fmt, width, height);   // 与 test_resize 读取原始文件时的帧大小一致
+    buf = av_malloc(size);
+    if (!buf)
+        return -12;
+    out = fopen(argv[5], "wb");
+    if (!out) {
+        printf("Fail to open %s\n", argv[5]);
+        return -1;
+    }
+    // 噪声图案每帧不同，渐变和棋盘格每帧相同
+    for (int i = 0; i < frames; i++) {
+        fill_frame(buf, pattern, width, height, fmt);
+        if (fwrite(buf, 1, size, out) != size) {
+            printf("Fail to write %s\n", argv[5]);
+            return -1;
+        }
+    }
+    fclose(out);
+    av_free(buf);
+    return 0;
+}
@@ -31,6 +31,105 @@ static const AVPixFmtDescriptor av_pix_fmt_descriptors[] = {
         .log2_chroma_w = 1,
         .log2_chroma_h = 1,
         .bpc           = 8,
+    },
+    [AV_PIX_FMT_YUV420P10] = {
+        .name = "yuv420p10",
+        .nb_components = 3,
+        .log2_chroma_w = 1,
+        .log2_chroma_h = 1,
+        .bpc           = 10,
+    },
+    [AV_PIX_FMT_YUV420P12] = {
+        .name = "yuv420p12",
+        .nb_components = 3,
+        .log2_chroma_w = 1,
+        .log2_chroma_h = 1,
+        .bpc           = 12,
+    },
+    [AV_PIX_FMT_YUV420P16] = {
+        .name = "yuv420p16",
+        .nb_components = 3,
+        .log2_chroma_w = 1,
+        .log2_chroma_h = 1,
+        .bpc           = 16,
+    },
+    [AV_PIX_FMT_YUV444P10] = {
+        .name = "yuv444p10",
+        .nb_components = 3,
+        .log2_chroma_w = 0,
+        .log2_chroma_h = 0,
+        .bpc           = 10,
+    },
+    [AV_PIX_FMT_P010] = {
+        .name = "p010",
+        .nb_components = 3,
+        .log2_chroma_w = 1,
+        .log2_chroma_h = 1,
+        .bpc           = 10,
+        .shift         = 6,
+    },
+    [AV_PIX_FMT_YUV422P] = {
+        .name = "yuv422p",
+        .nb_components = 3,
+        .log2_chroma_w = 1,
+        .log2_chroma_h = 0,
+        .bpc           = 8,
+    },
+    [AV_PIX_FMT_NV16] = {
+        .name = "nv16",
+        .nb_components = 3,
+        .log2_chroma_w = 1,
+        .log2_chroma_h = 0,
+        .bpc           = 8,
+    },
+    [AV_PIX_FMT_YUYV422] = {
+        .name = "yuyv422",
+        .nb_components = 3,
+        .log2_chroma_w = 1,
+        .log2_chroma_h = 0,
+        .bpc           = 8,
+    },
+    [AV_PIX_FMT_UYVY422] = {
+        .name = "uyvy422",
+        .nb_components = 3,
+        .log2_chroma_w = 1,
+        .log2_chroma_h = 0,
+        .bpc           = 8,
+    },
+    [AV_PIX_FMT_RGB24] = {
+        .name = "rgb24",
+        .nb_components = 3,
+        .log2_chroma_w = 0,
+        .log2_chroma_h = 0,
+        .bpc           = 8,
+    },
+    [AV_PIX_FMT_BGRA] = {
+        .name = "bgra",
+        .nb_components = 4,
+        .log2_chroma_w = 0,
+        .log2_chroma_h = 0,
+        .bpc           = 8,
+    },
+    [AV_PIX_FMT_YUVA420P] = {
+        .name = "yuva420p",
+        .nb_components = 4,
+        .log2_chroma_w = 1,
+        .log2_chroma_h = 1,
+        .bpc           = 8,
+    },
+    [AV_PIX_FMT_YUVA444P] = {
+        .name = "yuva444p",
+        .nb_components = 4,
+        .log2_chroma_w = 0,
+        .log2_chroma_h = 0,
+        .bpc           = 8,
+    },
+    [AV_PIX_FMT_GRAY8] = {
+        .name = "gray",
+        .nb_components = 1,
+        .log2_chroma_w = 0,
+        .log2_chroma_h = 0,
+        .bpc           = 8,
     }
 };
 
@@ -54,4 +153,47 @@ const AVPixFmtDescriptor *av_pix_fmt_desc_get(enum AVPixelFormat pix_fmt)
     if (pix_fmt < 0 || pix_fmt >= AV_PIX_FMT_NB)
         return NULL;
     return &av_pix_fmt_descriptors[pix_fmt];
-}
\ No newline at end of file
+}
+
+// 命令行中的格式名（如 "YUV420P"、"NV12"）转为枚举值
+enum AVPixelFormat getPixelFormatFromString(const char *format) {
+    if (strcmp(format, "YUV420P") == 0) {
+        return AV_PIX_FMT_YUV420P;
+    } else if (strcmp(format, "YUV444P") == 0) {
+        return AV_PIX_FMT_YUV444P;
+    } else if (strcmp(format, "NV12") == 0) {
+        return AV_PIX_FMT_NV12;
+    } else if (strcmp(format, "NV21") == 0) {
+        return AV_PIX_FMT_NV21;
+    } else if (strcmp(format, "YUV420P10") == 0) {
+        return AV_PIX_FMT_YUV420P10;
+    } else if (strcmp(format, "YUV420P12") == 0) {
+        return AV_PIX_FMT_YUV420P12;
+    } else if (strcmp(format, "YUV420P16") == 0) {
+        return AV_PIX_FMT_YUV420P16;
+    } else if (strcmp(format, "YUV444P10") == 0) {
+        return AV_PIX_FMT_YUV444P10;
+    } else if (strcmp(format, "P010") == 0) {
+        return AV_PIX_FMT_P010;
+    } else if (strcmp(format, "YUV422P") == 0) {
+        return AV_PIX_FMT_YUV422P;
+    } else if (strcmp(format, "NV16") == 0) {
+        return AV_PIX_FMT_NV16;
+    } else if (strcmp(format, "YUYV422") == 0) {
+        return AV_PIX_FMT_YUYV422;
+    } else if (strcmp(format, "UYVY422") == 0) {
+        return AV_PIX_FMT_UYVY422;
+    } else if (strcmp(format, "RGB24") == 0) {
+        return AV_PIX_FMT_RGB24;
+    } else if (strcmp(format, "BGRA") == 0) {
+        return AV_PIX_FMT_BGRA;
+    } else if (strcmp(format, "YUVA420P") == 0) {
+        return AV_PIX_FMT_YUVA420P;
+    } else if (strcmp(format, "YUVA444P") == 0) {
+        return AV_PIX_FMT_YUVA444P;
+    } else if (strcmp(format, "GRAY8") == 0) {
+        return AV_PIX_FMT_GRAY8;
+    } else {
+        return AV_PIX_FMT_NONE;     // 不认识的名字由调用者报错，不能悄悄当作YUV420P处理
+    }
+}
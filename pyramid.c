@@ -0,0 +1,142 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "swscale_internal.h"
+
+int sws_init_pyramid_context(SwsPyramidContext *p, int srcW, int srcH,
+                             enum AVPixelFormat format, int nb_levels)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(format);
+    int k, ret;
+
+    if (!desc || nb_levels <= 0)
+        return -22;
+
+    p->nb_levels = nb_levels;
+    p->chrVSubSample = desc->log2_chroma_h;
+    p->levels = av_mallocz_array(nb_levels, sizeof(*p->levels));
+    p->levelW = av_mallocz_array(nb_levels + 1, sizeof(*p->levelW));
+    p->levelH = av_mallocz_array(nb_levels + 1, sizeof(*p->levelH));
+    p->fed    = av_mallocz_array(nb_levels + 1, sizeof(*p->fed));
+    if (!p->levels || !p->levelW || !p->levelH || !p->fed)
+        return -12;
+
+    p->levelW[0] = srcW;
+    p->levelH[0] = srcH;
+    for (k = 1; k <= nb_levels; k++) {
+        p->levelW[k] = AV_CEIL_RSHIFT(p->levelW[k - 1], 1);
+        p->levelH[k] = AV_CEIL_RSHIFT(p->levelH[k - 1], 1);
+        if (p->levelW[k] < SWS_PYRAMID_MIN_SIZE || p->levelH[k] < SWS_PYRAMID_MIN_SIZE) {
+            fprintf(stderr, "sws_init_pyramid_context: level %d is too small (%dx%d)\n",
+                    k, p->levelW[k], p->levelH[k]);
+            return -22;
+        }
+    }
+
+    for (k = 0; k < nb_levels; k++) {
+        SwsContext *c = av_mallocz(sizeof(SwsContext));
+
+        if (!c)
+            return -12;
+        p->levels[k] = c;
+
+        c->srcW = p->levelW[k];
+        c->srcH = p->levelH[k];
+        c->srcFormat = format;
+        c->dstW = p->levelW[k + 1];
+        c->dstH = p->levelH[k + 1];
+        c->dstFormat = format;
+        c->flags = 2;
+
+        if ((ret = sws_init_context(c)) < 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+// 取得从第y行开始的切片的各平面指针，y必须是色度行的整数倍
+static void slice_from_row(const uint8_t *const planes[], const int stride[], int y, int vsub,
+                           const uint8_t *slice[4], int sliceStride[4])
+{
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        int sliceY = (i == 1 || i == 2) ? y >> vsub : y;
+
+        slice[i] = planes[i] ? planes[i] + sliceY * stride[i] : NULL;
+        sliceStride[i] = planes[i] ? stride[i] : 0;
+    }
+}
+
+/*
+ 把第k层中还没有送出的行送给下一层缩放，必要时递归送往更小的层
+ 除了最后一块，送出的行数都对齐到色度行，保证切片起点始终落在色度行的开头
+*/
+static int feed_level(SwsPyramidContext *p, int k, const uint8_t *const planes[],
+                      const int stride[], int available,
+                      uint8_t **const dst[], int *const dstStride[])
+{
+    SwsContext *c = p->levels[k];
+    int align = (1 << p->chrVSubSample) - 1;
+    int end = available == p->levelH[k] ? available : available & ~align;
+    const uint8_t *slice[4];
+    int sliceStride[4];
+    int ret;
+
+    if (end <= p->fed[k])
+        return 0;
+
+    slice_from_row(planes, stride, p->fed[k], p->chrVSubSample, slice, sliceStride);
+    if ((ret = sws_scale(c, slice, sliceStride, p->fed[k], end - p->fed[k], dst[k], dstStride[k])) < 0)
+        return ret;
+    p->fed[k] = end;
+
+    if (k + 1 < p->nb_levels)
+        return feed_level(p, k + 1, (const uint8_t *const *)dst[k], dstStride[k], c->dstY, dst, dstStride);
+    return 0;
+}
+
+int sws_scale_pyramid(SwsPyramidContext *p, const uint8_t *const src[], const int srcStride[],
+                      uint8_t **const dst[], int *const dstStride[])
+{
+    int y, k, ret;
+
+    // 参数错误时在写入任何一层之前返回；第k层的源是第k-1层的输出，已经作为目标检查过
+    if ((ret = ff_sws_check_planes(p->levels[0], src, srcStride, NULL, NULL)) < 0)
+        return ret;
+    for (k = 0; k < p->nb_levels; k++) {
+        if ((ret = ff_sws_check_planes(p->levels[k], NULL, NULL, dst[k], dstStride[k])) < 0)
+            return ret;
+    }
+
+    for (k = 0; k <= p->nb_levels; k++)
+        p->fed[k] = 0;
+
+    for (y = 0; y < p->levelH[0]; y += SWS_MULTI_SLICE_H) {
+        int available = FFMIN(y + SWS_MULTI_SLICE_H, p->levelH[0]);
+
+        if ((ret = feed_level(p, 0, src, srcStride, available, dst, dstStride)) < 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+void sws_free_pyramid_context(SwsPyramidContext *p)
+{
+    int k;
+
+    if (!p)
+        return;
+
+    if (p->levels) {
+        for (k = 0; k < p->nb_levels; k++)
+            sws_freeContext(p->levels[k]);
+    }
+    av_freep(&p->levels);
+    av_freep(&p->levelW);
+    av_freep(&p->levelH);
+    av_freep(&p->fed);
+}
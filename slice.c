@@ -1,6 +1,38 @@
 #include "swscale_internal.h"
 /// Color conversion instance data
 
+/*
+ 按照滤波器表的周期布局调用水平缩放函数
+ [0, head) 和 [tail, dstW) 使用单独保存的系数，[head, tail) 每 period 个输出复用同一段系数，
+ 同时源数据指针前进 step 个像素，这样缩放函数本身不需要知道表被压缩过
+*/
+static void h_scale_periodic(SwsContext *c,
+                             void (*hScale)(SwsContext *c, int16_t *dst, int dstW,
+                                            const uint8_t *src, const int16_t *filter,
+                                            const int32_t *filterPos, int filterSize),
+                             int16_t *dst, int dstW, const uint8_t *src, FilterContext *instance)
+{
+    const FilterPeriod *p = &instance->period;
+    const int16_t *filter = (const int16_t *)instance->filter;
+    const int32_t *filter_pos = instance->filter_pos;
+    int filter_size = instance->filter_size;
+    const int src_bytes = c->srcBpc > 8 ? 2 : 1;   // 输入样本的字节数
+    const int dst_elems = c->dstBpc == 16 ? 2 : 1; // 19位中间结果占两个int16_t
+    int x, offset;
+
+    if (p->head > 0)
+        hScale(c, dst, p->head, src, filter, filter_pos, filter_size);
+
+    for (x = p->head, offset = 0; x < p->tail; x += p->period, offset += p->step)
+        hScale(c, dst + x * dst_elems, FFMIN(p->period, p->tail - x), src + offset * src_bytes,
+               filter + p->head * filter_size, filter_pos + p->head, filter_size);
+
+    if (p->tail < dstW)
+        hScale(c, dst + p->tail * dst_elems, dstW - p->tail, src,
+               filter + (p->head + p->period) * filter_size,
+               filter_pos + p->head + p->period, filter_size);
+}
+
 static int lum_h_scale(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, int sliceH)
 {
     FilterContext *instance = desc->instance;
@@ -16,17 +48,27 @@ static int lum_h_scale(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, int
 
 
         if (c->hcScale) {  //链接到hScale8To15_c 所有的最终像素计算都由这个函数完成
-            c->hyScale(c, (int16_t*)dst[dst_pos], dstW, (const uint8_t *)src[src_pos], instance->filter,
-                       instance->filter_pos, instance->filter_size);
+            h_scale_periodic(c, c->hyScale, (int16_t*)dst[dst_pos], dstW, (const uint8_t *)src[src_pos], instance);
         }
 
         desc->dst->plane[0].sliceH += 1;
+
+        if (desc->alpha) {  // alpha平面和亮度使用同一套滤波器
+            src = desc->src->plane[3].line;
+            dst = desc->dst->plane[3].line;
+            src_pos = sliceY+i - desc->src->plane[3].sliceY;
+            dst_pos = sliceY+i - desc->dst->plane[3].sliceY;
+
+            h_scale_periodic(c, c->hyScale, (int16_t*)dst[dst_pos], dstW, (const uint8_t *)src[src_pos], instance);
+
+            desc->dst->plane[3].sliceH += 1;
+        }
     }
 
     return sliceH;
 }
 
-int ff_init_desc_hscale(SwsFilterDescriptor *desc, SwsSlice *src, SwsSlice *dst, uint16_t *filter, int * filter_pos, int filter_size, int xInc)
+int ff_init_desc_hscale(SwsFilterDescriptor *desc, SwsSlice *src, SwsSlice *dst, uint16_t *filter, int * filter_pos, int filter_size, int xInc, const FilterPeriod *period)
 {
     FilterContext *li = malloc(sizeof(FilterContext));
     if (!li)
@@ -36,6 +78,7 @@ int ff_init_desc_hscale(SwsFilterDescriptor *desc, SwsSlice *src, SwsSlice *dst,
     li->filter_pos = filter_pos;
     li->filter_size = filter_size;
     li->xInc = xInc;
+    li->period = *period;
 
     desc->instance = li;  // 放入对应平面的instance中
 
@@ -43,6 +86,7 @@ int ff_init_desc_hscale(SwsFilterDescriptor *desc, SwsSlice *src, SwsSlice *dst,
     desc->dst = dst;
 
     desc->process = &lum_h_scale;   // 缩放函数，在这里对参数进行计算
+    desc->name = "lum hscale";
 
     return 0;
 }
@@ -70,10 +114,10 @@ static int chr_h_scale(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, int
         // 如果存在水平色度缩放函数指针，则进行水平色度缩放处理
         if (c->hcScale) {
             // 对色度平面1进行水平缩放
-            c->hcScale(c, (uint16_t*)dst1[dst_pos1+i], dstW, src1[src_pos1+i], instance->filter, instance->filter_pos, instance->filter_size);
+            h_scale_periodic(c, c->hcScale, (int16_t*)dst1[dst_pos1+i], dstW, src1[src_pos1+i], instance);
 
             // 对色度平面2进行水平缩放
-            c->hcScale(c, (uint16_t*)dst2[dst_pos2+i], dstW, src2[src_pos2+i], instance->filter, instance->filter_pos, instance->filter_size);
+            h_scale_periodic(c, c->hcScale, (int16_t*)dst2[dst_pos2+i], dstW, src2[src_pos2+i], instance);
         }
         // 增加目标图像的色度平面切片高度
         desc->dst->plane[1].sliceH += 1;
@@ -85,6 +129,41 @@ static int chr_h_scale(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, int
 }
 
 
+static int lum_convert(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, int sliceH)
+{
+    int srcW = desc->src->width;
+    int i;
+
+    desc->dst->plane[0].sliceY = sliceY; // 设置目标图像的亮度平面的切片起始位置和切片高度
+    desc->dst->plane[0].sliceH = sliceH;
+    desc->dst->plane[3].sliceY = sliceY;
+    desc->dst->plane[3].sliceH = sliceH;
+
+    for (i = 0; i < sliceH; ++i) {
+        int sp0 = sliceY+i - desc->src->plane[0].sliceY;
+        const uint8_t * src = desc->src->plane[0].line[sp0];
+        uint8_t * dst = desc->dst->plane[0].line[i];
+
+        if (c->lumToYV12) {
+            c->lumToYV12(dst, src, srcW, c->input_rgb2yuv_table);  // 从打包数据中提取亮度
+        }
+        if (desc->alpha && c->alpToYV12) {
+            c->alpToYV12(desc->dst->plane[3].line[i], src, srcW, c->input_rgb2yuv_table);  // 提取alpha，随后与亮度一起水平缩放
+        }
+    }
+
+    return sliceH;
+}
+
+int ff_init_desc_fmt_convert(SwsFilterDescriptor *desc, SwsSlice * src, SwsSlice *dst)
+{
+    desc->src = src;
+    desc->dst = dst;
+    desc->process = &lum_convert;
+    desc->name = "lum convert";
+    return 0;
+}
+
 static int chr_convert(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, int sliceH)
 {
     int srcW = AV_CEIL_RSHIFT(desc->src->width, desc->src->h_chr_sub_sample);// 计算源图像的实际宽度
@@ -109,7 +188,7 @@ static int chr_convert(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, int
         uint8_t * dst1 = desc->dst->plane[1].line[i];
         uint8_t * dst2 = desc->dst->plane[2].line[i];
         if (c->chrToYV12) {
-            c->chrToYV12(dst1, dst2, src[1], srcW);// 如果存在色度转换函数指针，则进行色度转换并写入目标图像的色度平面
+            c->chrToYV12(dst1, dst2, src[1], srcW, c->input_rgb2yuv_table);// 如果存在色度转换函数指针，则进行色度转换并写入目标图像的色度平面
         }
     }
 
@@ -123,10 +202,11 @@ int ff_init_desc_cfmt_convert(SwsFilterDescriptor *desc, SwsSlice * src, SwsSlic
     desc->src = src;
     desc->dst = dst;
     desc->process = &chr_convert;
+    desc->name = "chr convert";
     return 0;
 }
 
-int ff_init_desc_chscale(SwsFilterDescriptor *desc, SwsSlice *src, SwsSlice *dst, uint16_t *filter, int * filter_pos, int filter_size, int xInc)
+int ff_init_desc_chscale(SwsFilterDescriptor *desc, SwsSlice *src, SwsSlice *dst, uint16_t *filter, int * filter_pos, int filter_size, int xInc, const FilterPeriod *period)
 {
     FilterContext *li = malloc(sizeof(FilterContext));
     if (!li)
@@ -136,6 +216,7 @@ int ff_init_desc_chscale(SwsFilterDescriptor *desc, SwsSlice *src, SwsSlice *dst
     li->filter_pos = filter_pos;
     li->filter_size = filter_size;
     li->xInc = xInc;
+    li->period = *period;
 
     desc->instance = li;
 
@@ -143,7 +224,28 @@ int ff_init_desc_chscale(SwsFilterDescriptor *desc, SwsSlice *src, SwsSlice *dst
     desc->dst = dst;
 
     desc->process = &chr_h_scale;
+    desc->name = "chr hscale";
+
+    return 0;
+}
+
+static int no_chr_scale(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, int sliceH)
+{
+    // 只推进色度切片的位置，不读写任何色度数据
+    desc->dst->plane[1].sliceY = sliceY + sliceH - desc->dst->plane[1].available_lines;
+    desc->dst->plane[1].sliceH = desc->dst->plane[1].available_lines;
+    desc->dst->plane[2].sliceY = sliceY + sliceH - desc->dst->plane[2].available_lines;
+    desc->dst->plane[2].sliceH = desc->dst->plane[2].available_lines;
+    return 0;
+}
 
+int ff_init_desc_no_chr(SwsFilterDescriptor *desc, SwsSlice *dst)
+{
+    desc->src = NULL;
+    desc->dst = dst;
+    desc->instance = NULL;
+    desc->process = &no_chr_scale;
+    desc->name = "chr skip";
     return 0;
 }
 
@@ -164,6 +266,18 @@ static int lum_planar_vscale(SwsContext *c, SwsFilterDescriptor *desc, int slice
     else
         ((yuv2planarX_fn)inst->pfn)(filter, inst->filter_size, (const int16_t**)src, dst[0], dstW);
 
+    if (desc->alpha) {  // alpha平面复用亮度的垂直滤波器
+        int sp = first - desc->src->plane[3].sliceY;
+        int dp = sliceY - desc->dst->plane[3].sliceY;
+        uint8_t **src = desc->src->plane[3].line + sp;
+        uint8_t **dst = desc->dst->plane[3].line + dp;
+
+        if (inst->filter_size == 1)
+            ((yuv2planar1_fn)inst->pfn)((const int16_t*)src[0], dst[0], dstW);
+        else
+            ((yuv2planarX_fn)inst->pfn)(filter, inst->filter_size, (const int16_t**)src, dst[0], dstW);
+    }
+
     return 1;
 }
 
@@ -202,42 +316,127 @@ static int chr_planar_vscale(SwsContext *c, SwsFilterDescriptor *desc, int slice
     return 1;
 }
 
+// 打包输出：亮度和色度由同一个函数一起做垂直缩放并写出
+static int packed_vscale(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, int sliceH)
+{
+    VScalerContext *inst = desc->instance;
+    int dstW = desc->dst->width;
+    int chrSliceY = sliceY >> desc->dst->v_chr_sub_sample;
+
+    int lum_fsize = inst[0].filter_size;
+    int chr_fsize = inst[1].filter_size;
+    uint16_t *lum_filter = inst[0].filter[0];
+    uint16_t *chr_filter = inst[1].filter[0];
+
+    int firstLum = FFMAX(1-lum_fsize, inst[0].filter_pos[   sliceY]);
+    int firstChr = FFMAX(1-chr_fsize, inst[1].filter_pos[chrSliceY]);
+
+    int sp0 = firstLum - desc->src->plane[0].sliceY;
+    int sp1 = firstChr - desc->src->plane[1].sliceY;
+    int sp2 = firstChr - desc->src->plane[2].sliceY;
+    int dp = sliceY - desc->dst->plane[0].sliceY;
+    uint8_t **src0 = desc->src->plane[0].line + sp0;
+    uint8_t **src1 = desc->src->plane[1].line + sp1;
+    uint8_t **src2 = desc->src->plane[2].line + sp2;
+    uint8_t **src3 = desc->alpha ? desc->src->plane[3].line + sp0 : NULL;  // alpha与亮度行一一对应
+    uint8_t **dst = desc->dst->plane[0].line + dp;
+
+    ((yuv2packedX_fn)inst->pfn)(c, (const int16_t*)lum_filter + sliceY * lum_fsize,
+                                (const int16_t**)src0, lum_fsize,
+                                (const int16_t*)chr_filter + chrSliceY * chr_fsize,
+                                (const int16_t**)src1, (const int16_t**)src2, chr_fsize,
+                                (const int16_t**)src3, *dst, dstW, sliceY);
+
+    return 1;
+}
+
 int ff_init_vscale(SwsContext *c, SwsFilterDescriptor *desc, SwsSlice *src, SwsSlice *dst)
 {
     VScalerContext *lumCtx = NULL;
     VScalerContext *chrCtx = NULL;
 
+    if (isPacked(c->dstFormat)) {   // 打包输出只需要一个描述符，亮度和色度上下文连续存放
+        lumCtx = av_mallocz(sizeof(VScalerContext) * 2);
+        if (!lumCtx)
+            return -12;
+
+        desc[0].process = packed_vscale;
+        desc[0].name = "packed vscale";
+        desc[0].instance = lumCtx;
+        desc[0].src = src;
+        desc[0].dst = dst;
+        desc[0].alpha = c->needAlpha;
+
+        ff_init_vscale_pfn(c, c->yuv2plane1, c->yuv2planeX, c->yuv2nv12cX, c->yuv2packedX);
+        return 0;
+    }
+
     lumCtx = av_mallocz(sizeof(VScalerContext));
     if (!lumCtx)
         return -12;
 
 
     desc[0].process = lum_planar_vscale;
+    desc[0].name = "lum vscale";
     desc[0].instance = lumCtx;
     desc[0].src = src;
     desc[0].dst = dst;
+    desc[0].alpha = c->needAlpha;
+
+    if (c->lumaOnly) {   // 只输出亮度，没有色度垂直描述符
+        ff_init_vscale_pfn(c, c->yuv2plane1, c->yuv2planeX, c->yuv2nv12cX, c->yuv2packedX);
+        return 0;
+    }
 
     chrCtx = av_mallocz(sizeof(VScalerContext));
     if (!chrCtx)
         return -12;  // -12为内存分配失败
     desc[1].process = chr_planar_vscale;
+    desc[1].name = "chr vscale";
     desc[1].instance = chrCtx;
     desc[1].src = src;
     desc[1].dst = dst;
 
-    ff_init_vscale_pfn(c, c->yuv2plane1, c->yuv2planeX, c->yuv2nv12cX);
+    ff_init_vscale_pfn(c, c->yuv2plane1, c->yuv2planeX, c->yuv2nv12cX, c->yuv2packedX);
     return 0;
 }
 
 void ff_init_vscale_pfn(SwsContext *c,
     yuv2planar1_fn yuv2plane1,
     yuv2planarX_fn yuv2planeX,
-    yuv2interleavedX_fn yuv2nv12cX)
+    yuv2interleavedX_fn yuv2nv12cX,
+    yuv2packedX_fn yuv2packedX)
 {
     VScalerContext *lumCtx = NULL;  // 亮度缩放上下文
     VScalerContext *chrCtx = NULL;  // 色度缩放上下文
     int idx = c->numDesc - 1;  // 获取描述符数组的索引
 
+    if (c->lumaOnly) {   // 最后一个描述符就是亮度
+        lumCtx = c->desc[idx].instance;
+        lumCtx->filter[0] = c->vLumFilter;
+        lumCtx->filter[1] = c->vLumFilter;
+        lumCtx->filter_size = c->vLumFilterSize;
+        lumCtx->filter_pos = c->vLumFilterPos;
+        lumCtx->pfn = c->vLumFilterSize == 1 ? (void *)yuv2plane1 : (void *)yuv2planeX;
+        return;
+    }
+
+    if (isPacked(c->dstFormat)) {
+        lumCtx = c->desc[idx].instance;
+        chrCtx = &lumCtx[1];
+
+        lumCtx->filter[0] = c->vLumFilter;
+        lumCtx->filter_size = c->vLumFilterSize;
+        lumCtx->filter_pos = c->vLumFilterPos;
+
+        chrCtx->filter[0] = c->vChrFilter;
+        chrCtx->filter_size = c->vChrFilterSize;
+        chrCtx->filter_pos = c->vChrFilterPos;
+
+        lumCtx->pfn = yuv2packedX;
+        return;
+    }
+
     chrCtx = c->desc[idx].instance;  // 获取色度缩放上下文实例
 
     // 设置色度滤波器和相关参数
@@ -337,12 +536,14 @@ static int alloc_slice(SwsSlice *s, enum AVPixelFormat fmt, int lumLines, int ch
 
     for (i = 0; i < 4; ++i) {
         int n = size[i] * (ring == 0 ? 1 : 3); // 计算每个平面需要的行数 如果环形缓冲区的化就×3，否则保持原始大小
-        s->plane[i].line = av_mallocz_array(sizeof(uint8_t*), n); // 分配内存用于存储行数据，一共n行，即该平面的行数
-        if (!s->plane[i].line)
-            return -12; // 内存分配失败
         s->plane[i].available_lines = size[i]; // 最大可用行数，也就是有效的行数
         s->plane[i].sliceY = 0;                 // 切片的起始行
         s->plane[i].sliceH = 0;                 // 切片的行数
+        if (!n)                                 // 只处理亮度时色度平面没有行
+            continue;
+        s->plane[i].line = av_mallocz_array(sizeof(uint8_t*), n); // 分配内存用于存储行数据，一共n行，即该平面的行数
+        if (!s->plane[i].line)
+            return -12; // 内存分配失败
     }
     return 0; // 成功分配内存
 }
@@ -402,7 +603,7 @@ int ff_rotate_slice(SwsSlice *s, int lum, int chr)
  @param relative 是否相对位置，0表示绝对位置，1表示相对位置
  @return 返回0表示初始化成功
 */
-int ff_init_slice_from_src(SwsSlice *s, uint8_t *src[4], int stride[4], int srcW, int lumY, int lumH, int chrY, int chrH, int relative)
+int ff_init_slice_from_src(SwsSlice *s, uint8_t *const src[4], const int stride[4], int srcW, int lumY, int lumH, int chrY, int chrH, int relative)
 {
     int i = 0;
 
@@ -410,12 +611,10 @@ int ff_init_slice_from_src(SwsSlice *s, uint8_t *src[4], int stride[4], int srcW
 
     const int end[4] = {lumY + lumH, chrY + chrH, chrY + chrH, lumY + lumH}; // 四个平面的结束Y坐标
 
-    uint8_t *const src_[4] = {
-        src[0] + (relative ? 0 : start[0]) * stride[0],
-        src[1] + (relative ? 0 : start[1]) * stride[1],
-        src[2] + (relative ? 0 : start[2]) * stride[2],
-        src[3] + (relative ? 0 : start[3]) * stride[3]
-    };
+    // 跨距用ptrdiff_t计算，负跨距（自底向上的图像）时行地址依次递减
+    uint8_t *src_[4];
+    for (i = 0; i < 4; ++i)
+        src_[i] = src[i] ? src[i] + (relative ? 0 : start[i]) * (ptrdiff_t)stride[i] : NULL;
 
     s->width = srcW; // 设置图像切片的宽度,也是每行的像素个数
 
@@ -429,14 +628,14 @@ int ff_init_slice_from_src(SwsSlice *s, uint8_t *src[4], int stride[4], int srcW
         if (start[i] >= first && n >= tot_lines) {      //如果总行数大于等于需要处理的行数
             s->plane[i].sliceH = FFMAX(tot_lines, s->plane[i].sliceH); // 设置切片的高度
             for (j = 0; j < lines; j += 1)
-                s->plane[i].line[start[i] - first + j] = src_[i] + j * stride[i]; // 填充切片数据
+                s->plane[i].line[start[i] - first + j] = src_[i] ? src_[i] + j * (ptrdiff_t)stride[i] : NULL; // 填充切片数据
         }
         else {  // 目前处理的情况一般走不到这里
             s->plane[i].sliceY = start[i]; // 设置切片的起始Y坐标
             lines = lines > n ? n : lines;
             s->plane[i].sliceH = lines; // 设置切片的高度
             for (j = 0; j < lines; j += 1)
-                s->plane[i].line[j] = src_[i] + j * stride[i]; // 填充切片数据
+                s->plane[i].line[j] = src_[i] ? src_[i] + j * (ptrdiff_t)stride[i] : NULL; // 填充切片数据
         }
     }
 
@@ -489,6 +688,11 @@ static void get_min_buffer_size(SwsContext *c, int *out_lum_size, int *out_chr_s
     *out_lum_size = lumFilterSize;// 初始化为滤波器大小
     *out_chr_size = chrFilterSize;
 
+    if (c->lumaOnly) {  // 没有色度滤波器，亮度只需要滤波器大小的行数
+        *out_chr_size = 0;
+        return;
+    }
+
     for (lumY = 0; lumY < dstH; lumY++) {   // 对亮度的行进行遍历
         int chrY = (int64_t)lumY * chrDstH / dstH; // 计算对应的色度行，
         int nextSlice = FFMAX(lumFilterPos[lumY] + lumFilterSize - 1,
@@ -507,22 +711,26 @@ int ff_init_filters(SwsContext *c)
 {
     int i;
     int index;                                      // 索引
-    int need_chr_conv = c->chrToYV12;               // 是否需要色度转换，NV12和NV21情况下需要
-    int num_ydesc = 1;                              // 亮度描述符数量
+    int need_lum_conv = c->lumToYV12 != NULL;       // 是否需要亮度转换，打包格式输入时需要
+    int need_chr_conv = c->chrToYV12 != NULL;       // 是否需要色度转换，NV和打包格式输入时需要
+    int num_ydesc = need_lum_conv ? 2 : 1;          // 亮度描述符数量
     int num_cdesc = need_chr_conv ? 2 : 1;          // 色度描述符数量
-    int num_vdesc = 2;                              // 垂直描述符数量 支持的四种格式都是YUV且Planar格式，因此固定为2
+    int num_vdesc = isPacked(c->dstFormat) || c->lumaOnly ? 1 : 2;  // 垂直描述符数量 平面输出亮度色度各一个，打包输出共用一个，只处理亮度时只有亮度
 
 
     int srcIdx, dstIdx;
     int dst_stride = FFALIGN(c->dstW * sizeof(int16_t) + 66, 16); // 目标图像的跨距
     int res = 0;
 
+    if (c->dstBpc == 16)   // 19位中间结果存放在int32_t中
+        dst_stride <<= 1;
+
     int lumBufSize;
     int chrBufSize;
     // 获取最小缓冲区大小 根据缩放比例确定，缩放比例越大，滤波器尺寸就越大，所需要的lumbuffer越大
     get_min_buffer_size(c, &lumBufSize, &chrBufSize);
     lumBufSize = FFMAX(lumBufSize, c->vLumFilterSize + MAX_LINES_AHEAD);
-    chrBufSize = FFMAX(chrBufSize, c->vChrFilterSize + MAX_LINES_AHEAD);
+    chrBufSize = c->lumaOnly ? 0 : FFMAX(chrBufSize, c->vChrFilterSize + MAX_LINES_AHEAD);
 
     c->numSlice = FFMAX(num_ydesc, num_cdesc) + 2;      // slice 的个数，取最大值并 +2，前面的用以存储输入相关的，后面+2用以存储输出相关的切片
     c->numDesc = num_ydesc + num_cdesc + num_vdesc;     //描述符的大小，由lum chr和垂直描述符个数和决定
@@ -537,7 +745,7 @@ int ff_init_filters(SwsContext *c)
 
     // 初始化第一个切片，也是用以存储输入数据的地方
     // 这个分配的内存是最大的，为输入数据分配数据
-    res = alloc_slice(&c->slice[0], c->srcFormat, c->srcH, c->chrSrcH, c->chrSrcHSubSample, c->chrSrcVSubSample, 0);
+    res = alloc_slice(&c->slice[0], c->srcFormat, c->srcH, c->lumaOnly ? 0 : c->chrSrcH, c->chrSrcHSubSample, c->chrSrcVSubSample, 0);
     if (res < 0) goto cleanup;
 
     // 初始化中间过程的切片数据
@@ -556,16 +764,25 @@ int ff_init_filters(SwsContext *c)
 
     // 初始化垂直缩放器输出切片，用以存储输出数据
     ++i;
-    res = alloc_slice(&c->slice[i], c->dstFormat, c->dstH, c->chrDstH, c->chrDstHSubSample, c->chrDstVSubSample, 0);
+    res = alloc_slice(&c->slice[i], c->dstFormat, c->dstH, c->lumaOnly ? 0 : c->chrDstH, c->chrDstHSubSample, c->chrDstVSubSample, 0);
     if (res < 0) goto cleanup;
 
     index = 0;
     srcIdx = 0;
     dstIdx = 1;
 
+    if (need_lum_conv) {  // 打包格式输入先提取亮度 此时后面所有的index都会+1
+        res = ff_init_desc_fmt_convert(&c->desc[index], &c->slice[srcIdx], &c->slice[dstIdx]);
+        if (res < 0) goto cleanup;
+        c->desc[index].alpha = c->needAlpha;  // BGRA输入时同时提取alpha
+        ++index;
+        srcIdx = dstIdx;
+    }
+
     dstIdx = FFMAX(num_ydesc, num_cdesc);
-    res = ff_init_desc_hscale(&c->desc[index], &c->slice[srcIdx], &c->slice[dstIdx], c->hLumFilter, c->hLumFilterPos, c->hLumFilterSize, c->lumXInc);
+    res = ff_init_desc_hscale(&c->desc[index], &c->slice[srcIdx], &c->slice[dstIdx], c->hLumFilter, c->hLumFilterPos, c->hLumFilterSize, c->lumXInc, &c->hLumFilterPeriod);
     if (res < 0) goto cleanup;
+    c->desc[index].alpha = c->needAlpha;  // alpha平面随亮度一起做水平缩放
 
     ++index;
     {  //色度平面的缩放器初始化 此时index=1
@@ -580,10 +797,12 @@ int ff_init_filters(SwsContext *c)
         }
 
         dstIdx = FFMAX(num_ydesc, num_cdesc);
-        printf("srcIdx:%d \n",srcIdx);
-        printf("dstIdx:%d \n",dstIdx);
+        ff_dlog("srcIdx:%d \n",srcIdx);
+        ff_dlog("dstIdx:%d \n",dstIdx);
         if (c->needs_hcscale)  //对色度平面进行水平缩放
-            res = ff_init_desc_chscale(&c->desc[index], &c->slice[srcIdx], &c->slice[dstIdx], c->hChrFilter, c->hChrFilterPos, c->hChrFilterSize, c->chrXInc);
+            res = ff_init_desc_chscale(&c->desc[index], &c->slice[srcIdx], &c->slice[dstIdx], c->hChrFilter, c->hChrFilterPos, c->hChrFilterSize, c->chrXInc, &c->hChrFilterPeriod);
+        else
+            res = ff_init_desc_no_chr(&c->desc[index], &c->slice[dstIdx]);
 
         if (res < 0) goto cleanup;
     }